@@ -11,19 +11,41 @@
 /* ************************************************************************** */
 
 #include "libft.h"
+#include <stdint.h>
 
+#define ONES (~0UL / 255)
+
+// Once s is aligned, bytes are compared a word at a time: the word
+// holds c when word ^ (c in every byte) has a zero byte.
 void	*ft_memchr(const void *s, int c, size_t n)
 {
-	size_t			i;
-	unsigned char	*src;
+	const unsigned char	*src;
+	const unsigned long	*word;
+	unsigned long		x;
 
-	i = 0;
-	src = (unsigned char *)s;
-	while (i < n)
+	src = (const unsigned char *)s;
+	while (n && ((uintptr_t)src % sizeof(long)) != 0)
+	{
+		if (*src == (unsigned char)c)
+			return ((void *)src);
+		src++;
+		n--;
+	}
+	word = (const unsigned long *)src;
+	while (n >= sizeof(long))
+	{
+		x = *word ^ (ONES * (unsigned char)c);
+		if ((x - ONES) & ~x & (ONES << 7))
+			break ;
+		word++;
+		n -= sizeof(long);
+	}
+	src = (const unsigned char *)word;
+	while (n--)
 	{
-		if (src[i] == (unsigned char)c)
-			return ((void *)(src + i));
-		i++;
+		if (*src == (unsigned char)c)
+			return ((void *)src);
+		src++;
 	}
 	return (NULL);
 }
@@ -0,0 +1,77 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   arith.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 15:20:14 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 15:20:16 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef ARITH_H
+# define ARITH_H
+
+# include "minishell.h"
+# include "env.h"
+
+// Instructions of the $((...)) stack machine
+typedef enum e_arith_op
+{
+	AOP_PUSH,	// push arg
+	AOP_LOAD,	// push variable names[arg]
+	AOP_STORE,	// names[arg] = top, value stays on the stack
+	AOP_PREINC,	// ++names[arg], push the new value
+	AOP_PREDEC,
+	AOP_POSTINC,	// names[arg]++, push the old value
+	AOP_POSTDEC,
+	AOP_POP,
+	AOP_NEG,
+	AOP_NOT,
+	AOP_BNOT,
+	AOP_BOOL,	// top = top != 0
+	AOP_POW,
+	AOP_MUL,
+	AOP_DIV,
+	AOP_MOD,
+	AOP_ADD,
+	AOP_SUB,
+	AOP_SHL,
+	AOP_SHR,
+	AOP_LT,
+	AOP_LE,
+	AOP_GT,
+	AOP_GE,
+	AOP_EQ,
+	AOP_NE,
+	AOP_BAND,
+	AOP_XOR,
+	AOP_BOR,
+	AOP_JMP,	// pc = arg
+	AOP_JZ,		// pop, pc = arg when it was 0
+	AOP_JNZ		// pop, pc = arg when it was not 0
+}	t_arith_op;
+
+typedef struct s_arith_insn
+{
+	int		op;
+	long long	arg;
+}	t_arith_insn;
+
+// One compiled expression, kept in a cache keyed by its source text
+typedef struct s_arith_prog
+{
+	char		*src;
+	t_arith_insn	*code;
+	int		len;
+	int		cap;
+	char		**names;	// variables referenced by LOAD/STORE
+	int		name_count;
+}	t_arith_prog;
+
+t_arith_prog	*arith_compile(const char *src);
+void			arith_free(t_arith_prog *prog);
+int				arith_eval(const char *src, t_env *env, long long *result);
+
+#endif
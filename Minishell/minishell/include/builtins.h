@@ -17,16 +17,60 @@
 # include "env.h"
 # include "parser.h"
 
+// Builtins by index, in the order of their names in builtins.c
+typedef enum e_builtin
+{
+	BI_ECHO,
+	BI_CD,
+	BI_PWD,
+	BI_EXPORT,
+	BI_UNSET,
+	BI_ENV,
+	BI_EXIT,
+	BI_SET,
+	BI_RETURN,
+	BI_TEST,
+	BI_BRACKET,
+	BI_TRUE,
+	BI_FALSE,
+	BI_COLON,
+	BI_BREAK,
+	BI_CONTINUE,
+	BI_ALIAS,
+	BI_UNALIAS,
+	BI_HISTORY,
+	BI_PUSHD,
+	BI_POPD,
+	BI_DIRS
+}	t_builtin;
+
+int	builtin_id(const char *name);
+const char	*builtin_name(int id);
 int	is_builtin(char *cmd);
-int	execute_builtin(t_simple_cmd *cmd, t_env *env);
+int	run_builtin(int id, t_simple_cmd *cmd, t_env *env);
 
 // Built-in functions
 int	builtin_echo(char **args);
 int	builtin_cd(char **args, t_env *env);
-int	builtin_pwd(void);
+int	builtin_pwd(char **args);
+int	parse_dir_options(char **args, const char *name, int *physical);
+int	change_dir(const char *dir, int physical, t_env *env);
+int	cd_to(const char *dir, int physical, t_env *env, int *announce);
+char	*cdpath_find(const char *dir, t_env *env, int *announce);
+void	cdpath_expire(void);
 int	builtin_export(char **args, t_env *env);
 int	builtin_unset(char **args, t_env *env);
-int	builtin_env(t_env *env);
+int	builtin_env(char **args, t_env *env);
 int	builtin_exit(char **args);
+int	builtin_set(char **args);
+int	builtin_return(char **args);
+int	builtin_test(char **args);
+int	builtin_break(char **args);
+int	builtin_alias(char **args);
+int	builtin_unalias(char **args);
+int	builtin_history(char **args);
+int	builtin_pushd(char **args, t_env *env);
+int	builtin_popd(char **args, t_env *env);
+int	builtin_dirs(char **args, t_env *env);
 
 #endif
\ No newline at end of file
@@ -17,10 +17,23 @@
 
 t_env	*init_env(char **envp);
 char	*get_env_value(t_env *env, char *key);
+t_env	*find_env(t_env *env, const char *key);
 void	set_env_value(t_env **env, char *key, char *value);
 void	remove_env_var(t_env **env, char *key);
 void	free_env(t_env *env);
 
+// The exported tier (exports.c)
+int	export_var(t_env *var);
+void	unexport_var(t_env *var);
+void	var_changed(t_env *var);
+void	var_moved(t_env *from, t_env *to);
+char	**get_envp(void);
+
+// The logical working directory (cwd.c)
+char	*canon_path(const char *base, const char *path);
+void	pwd_init(t_env **env);
+void	pwd_set(t_env *env, char *pwd);
+
 #endif
 
 
@@ -17,9 +17,90 @@
 # include "parser.h"
 # include "env.h"
 
+// One step of a compiled redirection plan
+typedef struct s_redir_step
+{
+	t_redir	*redir;
+	int	live;	// 0 when a later redirection replaces the same fd
+	int	fanout;	// multios: one of several files fed from the same fd
+	int	file_fd;	// opened file of a fan-out step, -1 otherwise
+}	t_redir_step;
+
+// An fd changed by apply_redirections() and where its original went
+typedef struct s_fd_backup
+{
+	int	fd;
+	int	saved;	// -1 when fd was not open before
+}	t_fd_backup;
+
+typedef struct s_redir_state
+{
+	t_fd_backup	*backups;
+	int		count;
+	pid_t		*helpers;	// multios fan-out processes to wait for
+	int		helper_count;
+}	t_redir_state;
+
+// A shell function: name() body
+typedef struct s_func
+{
+	char		*name;	// name and next as in t_named
+	struct s_func	*next;
+	t_command	*body;
+	int		refs;	// the table's reference plus one per running call
+}	t_func;
+
 // Execution functions
 int	execute_command(t_command *cmd, t_env *env);
-int	handle_heredoc(char *delimiter);
+int	execute_stage(t_command *cmd, t_env *env);
+int	execute_pipe_command(t_command *cmd, t_env *env);
+int	execute_builtin_command(t_simple_cmd *cmd, int builtin, t_env *env);
+int	execute_env_command(char **args, char **assigns, t_env *env);
+
+// Program environments (envp.c) and assignments (assign.c)
+void	free_env_array(char **env_array);
+char	**envp_overlay(char **envp, char **assigns);
+int	assign_variables(char **assigns, t_env *env);
+void	assign_words(char **words, t_env *env);
+char	**expand_assigns(char **assigns, t_env *env);
+t_env	*push_assigns(char **assigns, t_env *env);
+void	pop_assigns(t_env *saved, t_env *env);
+int	handle_heredoc(const char *body);
+
+// Redirections (state == NULL when the process is about to exec)
+int	apply_redirections(t_redir *redirs, t_redir_state *state);
+void	restore_redirections(t_redir_state *state);
+int	start_fanout(int fd, int *files, int count, t_redir_state *state);
+
+// Process substitutions still open in this process
+void	reap_process_substitutions(int mark);
+void	keep_process_substitutions_open(void);
+
+// Process helpers shared by the executor files
+pid_t	shell_fork(void);
+int	decode_wait_status(int status);
+
+// Shell functions
+t_func	*find_function(const char *name);
+int	define_function(const char *name, t_command *body);
+int	unset_function(const char *name);
+int	call_function(t_func *fn, t_simple_cmd *cmd, t_env *env);
+
+// Programs on PATH (pathcache.c)
+char	*path_lookup(const char *name, t_env *env);
+char	**path_complete(const char *prefix, t_env *env);
+void	path_cache_expire(void);
+
+// set -o argbatch: split an oversized argv over several execs
+int	argbatch_needed(char **args, char **envp);
+int	argbatch_run(char *path, char **args, char **envp, t_env *env);
+
+// Close-on-exec discipline for the shell's own fds
+int	shell_pipe(int fds[2]);
+void	size_pipeline_pipe(int fds[2]);
+int	shell_dup(int fd);
+void	cloexec_inherited_fds(void);
+void	trace_inherited_fds(const char *name);
 
 #endif
 
@@ -17,10 +17,123 @@
 # include "lexer.h"
 # include "env.h"
 
-// Expansion functions
-char	*expand_string(char *str, t_env *env, int exit_status, int quote_type);
-void	expand_tokens(t_token *tokens, t_env *env, int exit_status);
-// Remove tokens that became empty strings after expansion
-void	compact_empty_tokens(t_token **tokens);
+// Small growable string used while building an expanded word
+typedef struct s_strbuf
+{
+	char	*data;
+	size_t	len;
+	size_t	cap;
+	int	failed;	// an expansion reported an error
+	int	escape;	// what sb_append escapes, see below
+	int	fields;	// the word is split: "$@" may separate fields
+}	t_strbuf;
+
+// t_strbuf.escape
+# define ESCAPE_META 1		// `*?[\`: text that must match itself
+# define ESCAPE_BACKSLASH 2	// only `\`: unquoted text of a glob word
+# define ESCAPE_IFS 4		// also IFS characters: text that is not split
+
+// Unescaped, ends a field whatever IFS is ("$@" between parameters)
+# define FIELD_BREAK "\x1f"
+
+// expand_raw modes
+# define EXPAND_VARS 1
+# define EXPAND_PATTERN 2	// quoted text is escaped (${v#pat})
+# define EXPAND_GLOB 4		// as EXPAND_PATTERN, backslashes stay literal
+# define EXPAND_SPLIT 8		// only unquoted expansions keep IFS unescaped
+
+// One directory entry of a t_glob_dir listing
+typedef struct s_glob_entry
+{
+	const char	*name;
+	unsigned char	type;	// DT_* as reported by the directory
+}	t_glob_entry;
+
+// A directory read once and shared by every word of a command
+typedef struct s_glob_dir
+{
+	char			*path;
+	char			*chunks;	// buffers the names live in
+	t_glob_entry		*entries;
+	size_t			count;
+	size_t			cap;
+	struct s_glob_dir	*next;
+}	t_glob_dir;
+
+int	sb_append(t_strbuf *sb, const char *src, size_t n);
+
+// Expansion functions (run on raw lexer words right before execution)
+char	*expand_word(char *word, t_env *env, int exit_status);
+char	**expand_args(char **args, t_env *env, int exit_status);
+char	*expand_pattern(char *word, t_env *env, int exit_status);
+char	*remove_quotes(char *word);
+
+// ${v=w}, ${v:=w} or an assignment in $((...)) (effects.c)
+int	word_assigns(const char *word);
+int	words_assign(char **words);
+
+// ${...}: str[*i] is the '{', *i is left after the matching '}'
+void	expand_parameter(t_strbuf *sb, const char *str, int *i, t_env *env,
+			int exit_status);
+
+// Shell patterns and linear literal search
+size_t	pattern_literal_len(const char *pat);
+int	pattern_match(const char *pat, const char *str, size_t len);
+size_t	*kmp_table(const char *needle, size_t m);
+long	kmp_find(const char *hay, size_t n, const char *needle, size_t m,
+			const size_t *fail, int last);
+
+// Brace expansion tree of one word
+typedef enum e_brace_type
+{
+	BRACE_TEXT,	// text[0..len) of the raw word
+	BRACE_SEQ,	// kids one after the other
+	BRACE_ALT,	// {kid,kid,...}
+	BRACE_RANGE	// {from..to..step}
+}	t_brace_type;
+
+typedef struct s_brace
+{
+	t_brace_type	type;
+	size_t		count;	// words this node expands to
+	const char	*text;
+	size_t		len;
+	struct s_brace	**kids;
+	int		nkids;
+	int		grouped;	// a BRACE_SEQ with a group in it
+	long long	from;
+	long long	step;
+	int		width;	// zero padding of numbers, 0 for none
+	int		is_char;
+}	t_brace;
+
+int	brace_parse(const char *word, t_brace **tree, size_t *count);
+size_t	brace_fill(t_brace *tree, char **out);
+void	brace_free(t_brace *tree);
+
+// Pathname expansion of words expanded with EXPAND_GLOB
+int	glob_has_meta(const char *word);
+void	glob_unescape(char *word);
+char	**glob_expand(const char *pattern, t_glob_dir **cache, size_t *count);
+void	glob_free_cache(t_glob_dir *cache);
+
+// Positional parameters of the running function call
+char	*positional_value(const char *name, size_t len, char *buf,
+			size_t size);
+int	append_positional(t_strbuf *sb, char which);
+char	*join_positional(void);
+
+// Field splitting of words expanded with EXPAND_SPLIT
+void	ifs_load(t_env *env);
+int	ifs_member(char c);
+char	*ifs_trim(char *word);
+char	*ifs_field(char **cursor);
+
+// $(cmd): run cmd and return its output minus trailing newlines
+char	*command_substitution(const char *body, size_t len, t_env *env);
+
+// <(cmd) and >(cmd): start cmd on a pipe and return its /dev/fd path
+char	*process_substitution(const char *body, size_t len, int output,
+			t_env *env);
 
 #endif
@@ -0,0 +1,43 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   history.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:50:03 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:50:05 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HISTORY_H
+# define HISTORY_H
+
+# include "minishell.h"
+# include "env.h"
+
+// Reading input (input.c)
+char		*input_line(const char *prompt);
+void		input_sync(void);
+
+// Command history (history.c)
+void		history_init(t_env *env);
+void		history_add(const char *line);
+int		history_count(void);
+const char	*history_entry(int i);
+long		history_number(int i);
+void		history_clear(void);
+long		history_file_lines(void);
+const char	*history_file_line(long i, size_t *len);
+
+// Searching it (search.c, isearch.c)
+void		search_add(const char *line);
+long		history_entries(void);
+const char	*history_text(long id, size_t *len);
+long		search_history(const char *query, long before);
+int		history_isearch(int count, int key);
+
+// Tab completion (complete.c)
+void		complete_init(t_env *env);
+
+#endif
@@ -24,22 +24,59 @@ typedef enum e_token_type
 	TOKEN_REDIRECT_OUT,
 	TOKEN_HEREDOC,
 	TOKEN_APPEND,
+	TOKEN_REDIRECT_RDWR,	// <>
+	TOKEN_CLOBBER,		// >|
+	TOKEN_DUP_IN,		// <&
+	TOKEN_DUP_OUT,		// >&
+	TOKEN_LPAREN,
+	TOKEN_RPAREN,
+	TOKEN_SEMICOLON,
 	TOKEN_EOF
 } t_token_type;
 
 // Token structure
 typedef struct s_token
 {
-	char		*value;
+	char		*value;  // raw text; quotes are removed by the expander
 	t_token_type	type;
 	int		quote_type;  // 0=no quotes, 1=single, 2=double, 3=mixed
+	int		io_number;   // fd written before a redirection (2>), or -1
 	struct s_token	*next;
 }  t_token;
 
+// An alias: its text as defined and that text lexed
+typedef struct s_alias
+{
+	char		*name;	// name and next as in t_named
+	struct s_alias	*next;
+	char		*text;
+	t_token		*tokens;
+	int		blank;	// text ends in a blank: check the next word too
+	int		active;	// being expanded, not to be expanded again
+}	t_alias;
+
+// Whether the next word is looked up as an alias
+typedef struct s_alias_scan
+{
+	int	command;	// it would name a command
+	int	target;		// it is the target of a redirection
+}	t_alias_scan;
+
 // Lexer function prototypes
 t_token	*lexer(char *line);
+t_token	*lexer_raw(char *line);
+int	match_paren(const char *s, int i);
 void	free_tokens(t_token *tokens);
 
+// Aliases
+t_alias	*find_alias(const char *name);
+int	define_alias(const char *name, const char *text);
+int	remove_alias(const char *name);
+void	remove_all_aliases(void);
+t_alias	**list_aliases(int *count);
+int	alias_generation(void);
+int	alias_append(t_token ***tail, t_token *tok, t_alias_scan *scan);
+
 #endif
 
 
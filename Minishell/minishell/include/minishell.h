@@ -35,14 +35,72 @@ typedef struct s_env
 {
 	char			*key;
 	char			*value;
+	int			exported;	// in the exported tier (exports.c)
+	char			*entry;		// NAME=value for envp, NULL until built
 	struct s_env	*next;
 }	t_env;
 
+// Head of a node in a table chained by name (names.c). t_func, t_alias
+// and the other such nodes start with these two members, in this order.
+typedef struct s_named
+{
+	char		*name;
+	struct s_named	*next;
+}	t_named;
+
+// Shell options toggled with `set -o name` / `set +o name`
+typedef enum e_shopt
+{
+	OPT_LASTPIPE = 1 << 0,	// run the last pipeline stage in the shell
+	OPT_NOCLOBBER = 1 << 1,	// `>` refuses to truncate existing files
+	OPT_FDTRACE = 1 << 2,	// report the fds each exec'd program inherits
+	OPT_OPTIMIZE = 1 << 3,	// rewrite pipelines before running them
+	OPT_EXPLAIN = 1 << 4,	// report what the optimizer rewrote
+	OPT_MULTIOS = 1 << 5,	// `> a > b` writes to every file
+	OPT_ARGBATCH = 1 << 6	// split argv too big for execve (ARGBATCH)
+}	t_shopt;
+
+// A running <(cmd) or >(cmd) and the shell's end of its pipe
+typedef struct s_procsub
+{
+	int			fd;
+	pid_t			pid;
+	struct s_procsub	*next;
+}	t_procsub;
+
+// $1.. of the function call being run; argc is 0 at the top level
+typedef struct s_params
+{
+	int	argc;
+	char	**argv;	// argv[0] is $1
+}	t_params;
+
+// Shell-wide state that outlives a single command line
+typedef struct s_shell
+{
+	int		last_status;	// value of $?
+	int		options;	// set of t_shopt flags
+	int		pipe_size;	// pipeline pipe capacity in bytes, 0 = default
+	int		batch_jobs;	// argbatch batches run at once, 0 = 1
+	t_procsub	*procsubs;	// newest first, reaped by execute_command
+	int		procsub_count;
+	int		subst_count;	// $(...) run so far
+	t_params	params;
+	int		func_depth;	// function calls being run
+	int		returning;	// `return` ran: unwind to the call
+	int		interactive;	// stdin is a terminal: readline, history
+	int		reading;	// inside readline: Ctrl-C ends the line
+	char		*pwd;		// logical working directory, NULL if unknown
+}	t_shell;
+
 // Global variable for signal handling
 extern volatile sig_atomic_t g_sig;
 
 // Function prototypes
 void	minishell_loop(void);
+t_shell	*get_shell(void);
+unsigned long	hash_text(const char *s);
+t_named	**named_link(t_named **slot, const char *name);
 
 #endif
 
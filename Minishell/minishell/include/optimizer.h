@@ -0,0 +1,23 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   optimizer.h                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:31:12 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:31:14 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef OPTIMIZER_H
+# define OPTIMIZER_H
+
+# include "minishell.h"
+# include "parser.h"
+
+// Rewrite pass run between parse() and execute_command() when
+// `set -o optimize` is on; returns the (possibly new) root
+t_command	*optimize_command(t_command *cmd);
+
+#endif
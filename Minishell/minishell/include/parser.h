@@ -21,7 +21,12 @@ typedef enum e_command_type
 {
 	CMD_SIMPLE,
 	CMD_PIPE,
-	CMD_REDIRECT
+	CMD_REDIRECT,
+	CMD_SUBSHELL,	// ( list ) with its own redirections
+	CMD_LIST,	// left ; right
+	CMD_GROUP,	// { list; } in the current shell, uses data.subshell
+	CMD_FUNCDEF,	// name() body
+	CMD_COMPOUND	// if/while/until/for/case, compiled to data.compound
 } t_command_type;
 
 // Redirection types
@@ -30,14 +35,19 @@ typedef enum e_redir_type
 	REDIR_IN,
 	REDIR_OUT,
 	REDIR_HEREDOC,
-	REDIR_APPEND
+	REDIR_APPEND,
+	REDIR_RDWR,	// <>
+	REDIR_CLOBBER,	// >|
+	REDIR_DUP	// n>&m, n<&m, n>&- (file holds "m" or "-")
 } t_redir_type;
 
 // Redirection structure
 typedef struct s_redir
 {
 	t_redir_type	type;
+	int		fd;	// descriptor being redirected
 	char		*file;
+	char		*body;	// heredoc: its text, read when parsed
 	struct s_redir	*next;
 } t_redir;
 
@@ -46,6 +56,7 @@ typedef struct s_simple_cmd
 {
 	char		**args;
 	t_redir		*redirs;
+	char		**assigns;	// NAME=value words before the command name
 } t_simple_cmd;
 
 // Command structure (AST node)
@@ -59,13 +70,56 @@ typedef struct s_command
 		{
 			struct s_command	*left;
 			struct s_command	*right;
+			int			feed;	// left is a `cat FILE'
 		} pipe_cmd;
+		struct
+		{
+			struct s_command	*body;
+			t_redir			*redirs;
+		} subshell;
+		struct
+		{
+			struct s_command	*left;
+			struct s_command	*right;
+		} list;
+		struct
+		{
+			char			*name;
+			struct s_command	*body;
+		} funcdef;
+		struct
+		{
+			struct s_vm_prog	*prog;
+			t_redir			*redirs;
+		} compound;
 	} data;
 } t_command;
 
 // Parser function prototypes
 t_command	*parse(t_token *tokens);
+t_command	*parse_input(t_token *tokens, int *incomplete);
+int		is_assignment(const char *word);
 void		free_command(t_command *cmd);
+t_command	*copy_command(t_command *cmd);
+void		free_redirs(t_redir *redirs);
+
+// Here-document bodies (heredoc.c)
+int		heredoc_collect(t_token *tokens);
+char		*heredoc_take(void);
+void		heredoc_clear(void);
+
+// Shared by the parser files
+t_command	*parse_list(t_token **tokens);
+t_command	*parse_compound(t_token **tokens);
+t_command	*create_command(t_command_type type);
+int		parse_group_redirs(t_token **tokens, t_redir **redirs);
+int		is_reserved(t_token *token, const char *word);
+int		is_compound_start(t_token *token);
+int		is_newline(t_token *token);
+int		is_case_break(t_token *token);
+void		skip_newlines(t_token **tokens);
+void		syntax_error(t_token *token);
+void		parser_nest(int delta);
 
 #endif
 
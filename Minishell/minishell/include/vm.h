@@ -0,0 +1,85 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   vm.h                                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 21:02:11 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 21:02:13 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef VM_H
+# define VM_H
+
+# include "minishell.h"
+# include "parser.h"
+# include "env.h"
+
+// Instructions of the control-flow machine. if/while/until/for/case are
+// lowered into these as they are parsed; everything they run is either
+// a builtin resolved at compile time or a command tree for the executor.
+typedef enum e_vm_op
+{
+	VOP_BUILTIN,	// run simple command cmd as builtin arg
+	VOP_RUN,	// execute_command(cmd): externals, pipelines, groups
+	VOP_JUMP,	// pc = arg
+	VOP_JUMP_OK,	// pc = arg when $? is 0
+	VOP_JUMP_FAIL,	// pc = arg when $? is not 0
+	VOP_STATUS,	// $? = arg
+	VOP_LOOP_INIT,	// start loop slot, expanding words for a `for`
+	VOP_FOR_NEXT,	// name = next word of slot, or pc = arg when done
+	VOP_SAVE,	// remember $? as the status of loop slot
+	VOP_RESTORE,	// $? = status of loop slot, the loop's own status
+	VOP_CASE_WORD,	// expand words[0] as the subject of case slot
+	VOP_CASE_MATCH,	// pc = arg when the subject matches pattern words[0]
+	VOP_BREAK,	// $? = 0, pc = arg (-1: `levels` loops out, unresolved)
+	VOP_CONTINUE
+}	t_vm_op;
+
+typedef struct s_vm_insn
+{
+	int		op;
+	int		arg;
+	int		slot;	// loop or case state in the frame of a run
+	int		levels;	// break/continue: loops still to leave
+	t_command	*cmd;
+	char		**words;
+	char		*name;
+}	t_vm_insn;
+
+// One compiled compound command. Programs are immutable once built and
+// reference counted, so function definitions share them.
+typedef struct s_vm_prog
+{
+	t_vm_insn	*code;
+	int		len;
+	int		cap;
+	int		slots;
+	int		refs;
+	int		failed;	// an allocation failed while compiling
+}	t_vm_prog;
+
+// Per-run state of a loop or case
+typedef struct s_vm_slot
+{
+	char	**words;	// for: expanded words
+	int	next;
+	int	status;		// loop: status of the last body run
+	char	*subject;	// case: expanded word
+}	t_vm_slot;
+
+// Compiling (vm_compile.c)
+t_vm_prog	*vm_new(void);
+void		vm_release(t_vm_prog *prog);
+int		vm_emit(t_vm_prog *prog, int op, int arg);
+void		vm_patch(t_vm_prog *prog, int at);
+void		vm_patch_chain(t_vm_prog *prog, int head);
+int		vm_emit_command(t_vm_prog *prog, t_command *cmd);
+void		vm_close_loop(t_vm_prog *prog, int from, int top);
+
+// Running (vm_run.c)
+int		vm_run(t_vm_prog *prog, t_env *env);
+
+#endif
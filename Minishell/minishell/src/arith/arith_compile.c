@@ -0,0 +1,419 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   arith_compile.c                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 15:22:40 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 15:22:42 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "arith.h"
+
+// Precedence-climbing compiler from $((...)) text to t_arith_prog.
+// Operators follow C (and bash): comma, assignments, ?:, || && | ^ &,
+// equality, relational, shifts, + -, * / %, ** and the unary ones.
+
+typedef struct s_arith_parser
+{
+	const char	*src;
+	int		pos;
+	t_arith_prog	*prog;
+	int		error;
+}	t_arith_parser;
+
+typedef struct s_binop
+{
+	const char	*text;
+	int		prec;
+	int		op;
+}	t_binop;
+
+// Longest spellings first so that "<=" is not read as "<"
+static const t_binop	g_binops[] = {
+	{"||", 1, AOP_JNZ}, {"&&", 2, AOP_JZ}, {"==", 6, AOP_EQ},
+	{"!=", 6, AOP_NE}, {"<=", 7, AOP_LE}, {">=", 7, AOP_GE},
+	{"<<", 8, AOP_SHL}, {">>", 8, AOP_SHR}, {"**", 11, AOP_POW},
+	{"|", 3, AOP_BOR}, {"^", 4, AOP_XOR}, {"&", 5, AOP_BAND},
+	{"<", 7, AOP_LT}, {">", 7, AOP_GT}, {"+", 9, AOP_ADD},
+	{"-", 9, AOP_SUB}, {"*", 10, AOP_MUL}, {"/", 10, AOP_DIV},
+	{"%", 10, AOP_MOD}, {NULL, 0, 0}};
+
+// `x op= y` spellings and the operator they apply
+static const t_binop	g_assignops[] = {
+	{"<<=", 0, AOP_SHL}, {">>=", 0, AOP_SHR}, {"+=", 0, AOP_ADD},
+	{"-=", 0, AOP_SUB}, {"*=", 0, AOP_MUL}, {"/=", 0, AOP_DIV},
+	{"%=", 0, AOP_MOD}, {"&=", 0, AOP_BAND}, {"^=", 0, AOP_XOR},
+	{"|=", 0, AOP_BOR}, {"=", 0, AOP_STORE}, {NULL, 0, 0}};
+
+static int	emit(t_arith_parser *p, int op, long long arg)
+{
+	t_arith_insn	*grown;
+	t_arith_prog	*prog;
+
+	prog = p->prog;
+	if (prog->len == prog->cap)
+	{
+		prog->cap = prog->cap ? prog->cap * 2 : 16;
+		grown = malloc(sizeof(t_arith_insn) * prog->cap);
+		if (!grown)
+		{
+			p->error = 1;
+			return (0);
+		}
+		if (prog->code)
+			ft_memcpy(grown, prog->code, sizeof(t_arith_insn) * prog->len);
+		free(prog->code);
+		prog->code = grown;
+	}
+	prog->code[prog->len].op = op;
+	prog->code[prog->len].arg = arg;
+	return (prog->len++);
+}
+
+static void	patch_jump(t_arith_parser *p, int at)
+{
+	if (!p->error)
+		p->prog->code[at].arg = p->prog->len;
+}
+
+static void	skip_ws(t_arith_parser *p)
+{
+	while (p->src[p->pos] == ' ' || p->src[p->pos] == '\t'
+		|| p->src[p->pos] == '\n')
+		p->pos++;
+}
+
+static int	accept(t_arith_parser *p, const char *text)
+{
+	size_t	len;
+
+	skip_ws(p);
+	len = ft_strlen(text);
+	if (ft_strncmp(p->src + p->pos, text, len) != 0)
+		return (0);
+	p->pos += len;
+	return (1);
+}
+
+static int	is_name_start(char c)
+{
+	return (ft_isalpha(c) || c == '_');
+}
+
+// Index of the variable spelled at src[start..start+len), added if new
+static int	name_index(t_arith_parser *p, int start, int len)
+{
+	t_arith_prog	*prog;
+	char		**grown;
+	int		i;
+
+	prog = p->prog;
+	i = 0;
+	while (i < prog->name_count)
+	{
+		if ((int)ft_strlen(prog->names[i]) == len
+			&& ft_strncmp(prog->names[i], p->src + start, len) == 0)
+			return (i);
+		i++;
+	}
+	grown = malloc(sizeof(char *) * (prog->name_count + 1));
+	if (grown && prog->names)
+		ft_memcpy(grown, prog->names, sizeof(char *) * prog->name_count);
+	if (grown)
+	{
+		free(prog->names);
+		prog->names = grown;
+		prog->names[prog->name_count] = ft_substr(p->src, start, len);
+	}
+	if (!grown || !prog->names[prog->name_count])
+	{
+		p->error = 1;
+		return (-1);
+	}
+	return (prog->name_count++);
+}
+
+// Read `name` or `$name` at the current position; -1 when there is none
+static int	read_name(t_arith_parser *p)
+{
+	int	start;
+
+	skip_ws(p);
+	start = p->pos;
+	if (p->src[start] == '$' && is_name_start(p->src[start + 1]))
+		start++;
+	if (!is_name_start(p->src[start]))
+		return (-1);
+	p->pos = start;
+	while (ft_isalnum(p->src[p->pos]) || p->src[p->pos] == '_')
+		p->pos++;
+	return (name_index(p, start, p->pos - start));
+}
+
+static void	parse_assign(t_arith_parser *p);
+
+static void	parse_number(t_arith_parser *p)
+{
+	char		*end;
+	long long	value;
+
+	errno = 0;
+	value = strtoll(p->src + p->pos, &end, 0);
+	if (errno || ft_isalnum(*end) || *end == '_')
+		p->error = 1;
+	p->pos = end - p->src;
+	emit(p, AOP_PUSH, value);
+}
+
+static void	parse_primary(t_arith_parser *p)
+{
+	int	var;
+
+	skip_ws(p);
+	if (accept(p, "("))
+	{
+		parse_assign(p);
+		while (!p->error && accept(p, ","))
+		{
+			emit(p, AOP_POP, 0);
+			parse_assign(p);
+		}
+		if (!accept(p, ")"))
+			p->error = 1;
+	}
+	else if (ft_isdigit(p->src[p->pos]))
+		parse_number(p);
+	else
+	{
+		var = read_name(p);
+		if (var == -1)
+			p->error = 1;
+		else if (accept(p, "++"))
+			emit(p, AOP_POSTINC, var);
+		else if (accept(p, "--"))
+			emit(p, AOP_POSTDEC, var);
+		else
+			emit(p, AOP_LOAD, var);
+	}
+}
+
+static void	parse_unary(t_arith_parser *p)
+{
+	int	save;
+	int	var;
+	char	c;
+
+	skip_ws(p);
+	save = p->pos;
+	if (ft_strncmp(p->src + p->pos, "++", 2) == 0
+		|| ft_strncmp(p->src + p->pos, "--", 2) == 0)
+	{
+		p->pos += 2;
+		var = read_name(p);
+		if (var != -1)
+		{
+			emit(p, p->src[save] == '+' ? AOP_PREINC : AOP_PREDEC, var);
+			return ;
+		}
+		p->pos = save; // --5 is two signs
+	}
+	c = p->src[p->pos];
+	if (c != '!' && c != '~' && c != '-' && c != '+')
+	{
+		parse_primary(p);
+		return ;
+	}
+	p->pos++;
+	parse_unary(p);
+	if (c == '!')
+		emit(p, AOP_NOT, 0);
+	else if (c == '~')
+		emit(p, AOP_BNOT, 0);
+	else if (c == '-')
+		emit(p, AOP_NEG, 0);
+}
+
+// The binary operator at the current position, without consuming it.
+// `a |= b` style spellings are assignments, not binary operators.
+static const t_binop	*peek_binop(t_arith_parser *p)
+{
+	const t_binop	*op;
+	size_t		len;
+
+	skip_ws(p);
+	op = g_binops;
+	while (op->text)
+	{
+		len = ft_strlen(op->text);
+		if (ft_strncmp(p->src + p->pos, op->text, len) == 0)
+		{
+			// only comparisons (precedence 6 and 7) may end in '='
+			if (p->src[p->pos + len] == '=' && op->prec != 6
+				&& op->prec != 7)
+				return (NULL);
+			return (op);
+		}
+		op++;
+	}
+	return (NULL);
+}
+
+static void	parse_binary(t_arith_parser *p, int min_prec);
+
+// a && b  =>  a JZ(L0) b BOOL JMP(L1) L0: PUSH 0 L1:
+static void	emit_logical(t_arith_parser *p, const t_binop *op)
+{
+	int	skip;
+	int	done;
+
+	skip = emit(p, op->op, 0);
+	parse_binary(p, op->prec + 1);
+	emit(p, AOP_BOOL, 0);
+	done = emit(p, AOP_JMP, 0);
+	patch_jump(p, skip);
+	emit(p, AOP_PUSH, op->op == AOP_JNZ);
+	patch_jump(p, done);
+}
+
+static void	parse_binary(t_arith_parser *p, int min_prec)
+{
+	const t_binop	*op;
+
+	parse_unary(p);
+	while (!p->error)
+	{
+		op = peek_binop(p);
+		if (!op || op->prec < min_prec)
+			return ;
+		p->pos += ft_strlen(op->text);
+		if (op->op == AOP_JZ || op->op == AOP_JNZ)
+			emit_logical(p, op);
+		else
+		{
+			// ** is the only right-associative binary operator
+			parse_binary(p, op->op == AOP_POW ? op->prec : op->prec + 1);
+			emit(p, op->op, 0);
+		}
+	}
+}
+
+static void	parse_ternary(t_arith_parser *p)
+{
+	int	skip;
+	int	done;
+
+	parse_binary(p, 1);
+	if (p->error || !accept(p, "?"))
+		return ;
+	skip = emit(p, AOP_JZ, 0);
+	parse_assign(p);
+	if (!accept(p, ":"))
+		p->error = 1;
+	done = emit(p, AOP_JMP, 0);
+	patch_jump(p, skip);
+	parse_assign(p);
+	patch_jump(p, done);
+}
+
+static const t_binop	*peek_assignop(t_arith_parser *p)
+{
+	const t_binop	*op;
+	size_t		len;
+
+	skip_ws(p);
+	op = g_assignops;
+	while (op->text)
+	{
+		len = ft_strlen(op->text);
+		if (ft_strncmp(p->src + p->pos, op->text, len) == 0
+			&& !(op->op == AOP_STORE && p->src[p->pos + 1] == '='))
+			return (op);
+		op++;
+	}
+	return (NULL);
+}
+
+// name = expr, name op= expr (right-associative), else a ?: expression
+static void	parse_assign(t_arith_parser *p)
+{
+	const t_binop	*op;
+	int		save;
+	int		var;
+
+	skip_ws(p);
+	save = p->pos;
+	op = NULL;
+	var = -1;
+	if (is_name_start(p->src[p->pos]))
+		var = read_name(p);
+	if (var != -1)
+		op = peek_assignop(p);
+	if (!op)
+	{
+		p->pos = save;
+		parse_ternary(p);
+		return ;
+	}
+	p->pos += ft_strlen(op->text);
+	if (op->op != AOP_STORE)
+		emit(p, AOP_LOAD, var);
+	parse_assign(p);
+	if (op->op != AOP_STORE)
+		emit(p, op->op, 0);
+	emit(p, AOP_STORE, var);
+}
+
+void	arith_free(t_arith_prog *prog)
+{
+	int	i;
+
+	if (!prog)
+		return ;
+	i = 0;
+	while (i < prog->name_count)
+		free(prog->names[i++]);
+	free(prog->names);
+	free(prog->code);
+	free(prog->src);
+	free(prog);
+}
+
+// Compile src once; the caller caches the result. Prints the error and
+// returns NULL when src is not a valid expression.
+t_arith_prog	*arith_compile(const char *src)
+{
+	t_arith_parser	p;
+
+	p.prog = ft_calloc(1, sizeof(t_arith_prog));
+	if (!p.prog)
+		return (NULL);
+	p.prog->src = ft_strdup(src);
+	p.src = src;
+	p.pos = 0;
+	p.error = (p.prog->src == NULL);
+	skip_ws(&p);
+	if (!p.src[p.pos])
+		emit(&p, AOP_PUSH, 0); // $(( )) is 0
+	else
+	{
+		parse_assign(&p);
+		while (!p.error && accept(&p, ","))
+		{
+			emit(&p, AOP_POP, 0);
+			parse_assign(&p);
+		}
+	}
+	skip_ws(&p);
+	if (!p.error && p.src[p.pos])
+		p.error = 1;
+	if (p.error)
+	{
+		fprintf(stderr, "minishell: %s: arithmetic syntax error\n", src);
+		arith_free(p.prog);
+		return (NULL);
+	}
+	return (p.prog);
+}
@@ -0,0 +1,387 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   arith_eval.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 15:41:03 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 15:41:05 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "arith.h"
+
+// Stack machine for compiled $((...)) programs, plus the cache that
+// makes a loop body's `$((i + 1))` compile only once. Arithmetic is on
+// 64-bit integers and wraps around like bash instead of overflowing.
+
+#define ARITH_CACHE_SLOTS 256
+#define ARITH_CACHE_MAX 1024
+#define ARITH_MAX_DEPTH 16
+
+typedef struct s_arith_entry
+{
+	unsigned long		hash;
+	t_arith_prog		*prog;
+	struct s_arith_entry	*next;
+}	t_arith_entry;
+
+typedef int	(*t_arith_binary)(long long a, long long b, long long *out);
+
+static t_arith_entry	*g_arith_cache[ARITH_CACHE_SLOTS];
+static int		g_arith_cached;
+
+static int	eval_depth(const char *src, t_env *env, long long *result,
+				int depth);
+
+static int	op_pow(long long a, long long b, long long *out)
+{
+	unsigned long long	base;
+	unsigned long long	acc;
+
+	if (b < 0)
+		return (1);
+	base = a;
+	acc = 1;
+	while (b)
+	{
+		if (b & 1)
+			acc *= base;
+		base *= base;
+		b >>= 1;
+	}
+	*out = (long long)acc;
+	return (0);
+}
+
+static int	op_mul(long long a, long long b, long long *out)
+{
+	*out = (long long)((unsigned long long)a * (unsigned long long)b);
+	return (0);
+}
+
+// LLONG_MIN / -1 traps on x86, so -1 is handled as a negation
+static int	op_div(long long a, long long b, long long *out)
+{
+	if (b == 0)
+		return (1);
+	if (b == -1)
+		*out = (long long)(0ULL - (unsigned long long)a);
+	else
+		*out = a / b;
+	return (0);
+}
+
+static int	op_mod(long long a, long long b, long long *out)
+{
+	if (b == 0)
+		return (1);
+	if (b == -1)
+		*out = 0;
+	else
+		*out = a % b;
+	return (0);
+}
+
+static int	op_add(long long a, long long b, long long *out)
+{
+	*out = (long long)((unsigned long long)a + (unsigned long long)b);
+	return (0);
+}
+
+static int	op_sub(long long a, long long b, long long *out)
+{
+	*out = (long long)((unsigned long long)a - (unsigned long long)b);
+	return (0);
+}
+
+static int	op_shl(long long a, long long b, long long *out)
+{
+	*out = (long long)((unsigned long long)a << (b & 63));
+	return (0);
+}
+
+static int	op_shr(long long a, long long b, long long *out)
+{
+	*out = a >> (b & 63);
+	return (0);
+}
+
+static int	op_lt(long long a, long long b, long long *out)
+{
+	*out = a < b;
+	return (0);
+}
+
+static int	op_le(long long a, long long b, long long *out)
+{
+	*out = a <= b;
+	return (0);
+}
+
+static int	op_gt(long long a, long long b, long long *out)
+{
+	*out = a > b;
+	return (0);
+}
+
+static int	op_ge(long long a, long long b, long long *out)
+{
+	*out = a >= b;
+	return (0);
+}
+
+static int	op_eq(long long a, long long b, long long *out)
+{
+	*out = a == b;
+	return (0);
+}
+
+static int	op_ne(long long a, long long b, long long *out)
+{
+	*out = a != b;
+	return (0);
+}
+
+static int	op_band(long long a, long long b, long long *out)
+{
+	*out = a & b;
+	return (0);
+}
+
+static int	op_xor(long long a, long long b, long long *out)
+{
+	*out = a ^ b;
+	return (0);
+}
+
+static int	op_bor(long long a, long long b, long long *out)
+{
+	*out = a | b;
+	return (0);
+}
+
+// Indexed by op - AOP_POW, in t_arith_op order
+static const t_arith_binary	g_binary[] = {
+	op_pow, op_mul, op_div, op_mod, op_add, op_sub, op_shl, op_shr,
+	op_lt, op_le, op_gt, op_ge, op_eq, op_ne, op_band, op_xor, op_bor};
+
+static int	arith_error(t_arith_prog *prog, const char *msg)
+{
+	fprintf(stderr, "minishell: %s: %s\n", prog->src, msg);
+	return (1);
+}
+
+// Unset and empty variables are 0; a value like "x + 1" is itself
+// evaluated as an expression
+static int	load_var(t_env *env, char *name, long long *out, int depth)
+{
+	char	*value;
+	char	*end;
+
+	value = get_env_value(env, name);
+	*out = 0;
+	if (!value)
+		return (0);
+	errno = 0;
+	*out = strtoll(value, &end, 0);
+	while (*end == ' ' || *end == '\t')
+		end++;
+	if (!errno && *end == '\0')
+		return (0);
+	if (depth >= ARITH_MAX_DEPTH)
+	{
+		fprintf(stderr, "minishell: %s: expression recursion level "
+			"exceeded\n", value);
+		return (1);
+	}
+	return (eval_depth(value, env, out, depth + 1));
+}
+
+static void	store_var(t_env *env, char *name, long long value)
+{
+	char	buf[24];
+
+	snprintf(buf, sizeof(buf), "%lld", value);
+	set_env_value(&env, name, buf);
+}
+
+// ++x, --x, x++, x--
+static int	step_incdec(t_arith_prog *prog, t_arith_insn *insn, long long *top,
+		t_env *env, int depth)
+{
+	long long	old;
+	long long	new;
+
+	if (load_var(env, prog->names[insn->arg], &old, depth))
+		return (1);
+	if (insn->op == AOP_PREINC || insn->op == AOP_POSTINC)
+		op_add(old, 1, &new);
+	else
+		op_sub(old, 1, &new);
+	store_var(env, prog->names[insn->arg], new);
+	if (insn->op == AOP_PREINC || insn->op == AOP_PREDEC)
+		*top = new;
+	else
+		*top = old;
+	return (0);
+}
+
+// Everything that is neither a binary operator nor a jump
+static int	step_other(t_arith_prog *prog, t_arith_insn *insn, long long *st,
+		int *sp)
+{
+	if (insn->op == AOP_POP)
+		(*sp)--;
+	else if (insn->op == AOP_NEG)
+		st[*sp - 1] = (long long)(0ULL - (unsigned long long)st[*sp - 1]);
+	else if (insn->op == AOP_NOT)
+		st[*sp - 1] = !st[*sp - 1];
+	else if (insn->op == AOP_BNOT)
+		st[*sp - 1] = ~st[*sp - 1];
+	else if (insn->op == AOP_BOOL)
+		st[*sp - 1] = st[*sp - 1] != 0;
+	else
+		return (arith_error(prog, "bad instruction"));
+	return (0);
+}
+
+// One instruction; the hot ones are tested first
+static int	step(t_arith_prog *prog, long long *st, int *sp, int *pc,
+		t_env *env, int depth)
+{
+	t_arith_insn	*insn;
+
+	insn = &prog->code[(*pc)++];
+	if (insn->op == AOP_PUSH)
+		st[(*sp)++] = insn->arg;
+	else if (insn->op == AOP_LOAD)
+		return (load_var(env, prog->names[insn->arg], &st[(*sp)++], depth));
+	else if (insn->op >= AOP_POW && insn->op <= AOP_BOR)
+	{
+		(*sp)--;
+		if (g_binary[insn->op - AOP_POW](st[*sp - 1], st[*sp], &st[*sp - 1]))
+			return (arith_error(prog, insn->op == AOP_POW
+					? "exponent less than 0" : "division by 0"));
+	}
+	else if (insn->op == AOP_STORE)
+		store_var(env, prog->names[insn->arg], st[*sp - 1]);
+	else if (insn->op == AOP_JMP)
+		*pc = insn->arg;
+	else if (insn->op == AOP_JZ || insn->op == AOP_JNZ)
+	{
+		(*sp)--;
+		if ((st[*sp] == 0) == (insn->op == AOP_JZ))
+			*pc = insn->arg;
+	}
+	else if (insn->op >= AOP_PREINC && insn->op <= AOP_POSTDEC)
+		return (step_incdec(prog, insn, &st[(*sp)++], env, depth));
+	else
+		return (step_other(prog, insn, st, sp));
+	return (0);
+}
+
+// Every instruction pushes at most one value, so len bounds the stack
+static int	run(t_arith_prog *prog, t_env *env, long long *result, int depth)
+{
+	long long	small[64];
+	long long	*st;
+	int		sp;
+	int		pc;
+	int		status;
+
+	st = small;
+	if (prog->len > 64)
+		st = malloc(sizeof(long long) * prog->len);
+	if (!st)
+		return (1);
+	sp = 0;
+	pc = 0;
+	status = 0;
+	while (pc < prog->len && status == 0)
+		status = step(prog, st, &sp, &pc, env, depth);
+	if (status == 0)
+		*result = st[sp - 1];
+	if (st != small)
+		free(st);
+	return (status);
+}
+
+static void	flush_cache(void)
+{
+	t_arith_entry	*next;
+	int		i;
+
+	i = 0;
+	while (i < ARITH_CACHE_SLOTS)
+	{
+		while (g_arith_cache[i])
+		{
+			next = g_arith_cache[i]->next;
+			arith_free(g_arith_cache[i]->prog);
+			free(g_arith_cache[i]);
+			g_arith_cache[i] = next;
+		}
+		i++;
+	}
+	g_arith_cached = 0;
+}
+
+// Cached program for src, compiling it on a miss. Nested evaluations
+// (depth > 0) never flush the cache: the caller's program is running.
+static t_arith_prog	*lookup(const char *src, int depth, int *owned)
+{
+	t_arith_entry	*entry;
+	unsigned long	hash;
+	t_arith_prog	*prog;
+
+	hash = hash_text(src);
+	entry = g_arith_cache[hash % ARITH_CACHE_SLOTS];
+	while (entry && (entry->hash != hash || ft_strncmp(entry->prog->src, src,
+				ft_strlen(src) + 1) != 0))
+		entry = entry->next;
+	*owned = 0;
+	if (entry)
+		return (entry->prog);
+	prog = arith_compile(src);
+	if (!prog)
+		return (NULL);
+	if (g_arith_cached >= ARITH_CACHE_MAX && depth == 0)
+		flush_cache();
+	entry = NULL;
+	if (g_arith_cached < ARITH_CACHE_MAX)
+		entry = malloc(sizeof(t_arith_entry));
+	*owned = (entry == NULL);
+	if (!entry)
+		return (prog);
+	entry->hash = hash;
+	entry->prog = prog;
+	entry->next = g_arith_cache[hash % ARITH_CACHE_SLOTS];
+	g_arith_cache[hash % ARITH_CACHE_SLOTS] = entry;
+	g_arith_cached++;
+	return (prog);
+}
+
+static int	eval_depth(const char *src, t_env *env, long long *result,
+		int depth)
+{
+	t_arith_prog	*prog;
+	int		owned;
+	int		status;
+
+	prog = lookup(src, depth, &owned);
+	if (!prog)
+		return (1);
+	status = run(prog, env, result, depth);
+	if (owned)
+		arith_free(prog);
+	return (status);
+}
+
+// Evaluate src (the inside of $((...))). Returns 0 and sets *result,
+// or prints the error and returns 1.
+int	arith_eval(const char *src, t_env *env, long long *result)
+{
+	return (eval_depth(src, env, result, 0));
+}
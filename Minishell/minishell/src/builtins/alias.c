@@ -0,0 +1,144 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   alias.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:46:19 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:46:21 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+#include "lexer.h"
+
+// alias [name[=text]...] and unalias [-a] name...
+
+// A name the lexer could read back as one plain word
+static int	is_alias_name(const char *name, size_t len)
+{
+	size_t	i;
+
+	if (len == 0)
+		return (0);
+	i = 0;
+	while (i < len)
+	{
+		if (ft_strchr(" \t\n/$`=\\'\"|&;()<>", name[i]))
+			return (0);
+		i++;
+	}
+	return (1);
+}
+
+// alias name='text', with quotes in text written as '\''
+static void	print_alias(t_alias *alias)
+{
+	char	*s;
+
+	printf("alias %s='", alias->name);
+	s = alias->text;
+	while (*s)
+	{
+		if (*s == '\'')
+			printf("'\\''");
+		else
+			putchar(*s);
+		s++;
+	}
+	printf("'\n");
+}
+
+static int	print_all(void)
+{
+	t_alias	**list;
+	int	count;
+	int	i;
+
+	list = list_aliases(&count);
+	if (!list)
+		return (1);
+	i = 0;
+	while (i < count)
+		print_alias(list[i++]);
+	free(list);
+	return (0);
+}
+
+static int	alias_one(char *arg)
+{
+	char	*eq;
+	char	*name;
+	int	status;
+
+	eq = ft_strchr(arg, '=');
+	if (!eq)
+	{
+		if (!find_alias(arg))
+		{
+			fprintf(stderr, "minishell: alias: %s: not found\n", arg);
+			return (1);
+		}
+		print_alias(find_alias(arg));
+		return (0);
+	}
+	if (!is_alias_name(arg, eq - arg))
+	{
+		fprintf(stderr, "minishell: alias: `%.*s': invalid alias name\n",
+			(int)(eq - arg), arg);
+		return (1);
+	}
+	name = ft_substr(arg, 0, eq - arg);
+	if (!name)
+		return (1);
+	status = define_alias(name, eq + 1);
+	free(name);
+	return (status);
+}
+
+int	builtin_alias(char **args)
+{
+	int	status;
+	int	i;
+
+	if (!args[1])
+		return (print_all());
+	status = 0;
+	i = 1;
+	while (args[i])
+	{
+		if (alias_one(args[i++]) != 0)
+			status = 1;
+	}
+	return (status);
+}
+
+int	builtin_unalias(char **args)
+{
+	int	status;
+	int	i;
+
+	if (args[1] && ft_strncmp(args[1], "-a", 3) == 0)
+	{
+		remove_all_aliases();
+		return (0);
+	}
+	if (!args[1])
+	{
+		fprintf(stderr, "unalias: usage: unalias [-a] name [name ...]\n");
+		return (2);
+	}
+	status = 0;
+	i = 1;
+	while (args[i])
+	{
+		if (!remove_alias(args[i]))
+		{
+			fprintf(stderr, "minishell: unalias: %s: not found\n", args[i]);
+			status = 1;
+		}
+		i++;
+	}
+	return (status);
+}
@@ -0,0 +1,22 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   break.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:09:40 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:09:42 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+
+// break/continue inside a loop are compiled into jumps (vm_compile.c);
+// the builtin only runs where there is no loop to leave.
+int	builtin_break(char **args)
+{
+	fprintf(stderr, "minishell: %s: only meaningful in a `for', `while', "
+		"or `until' loop\n", args[0]);
+	return (0);
+}
@@ -11,145 +11,103 @@
 /* ************************************************************************** */
 
 #include "builtins.h"
-#include <fcntl.h>
+#include "executor.h"
 
-int	is_builtin(char *cmd)
+// Builtin names in t_builtin order
+static const char	*g_builtin_names[] = {"echo", "cd", "pwd", "export",
+	"unset", "env", "exit", "set", "return", "test", "[", "true", "false",
+	":", "break", "continue", "alias", "unalias", "history", "pushd", "popd",
+	"dirs", NULL};
+
+// The t_builtin called name, or -1
+int	builtin_id(const char *name)
 {
-	if (!cmd)
-		return (0);
-	if (ft_strncmp(cmd, "echo", 5) == 0)
-		return (1);
-	if (ft_strncmp(cmd, "cd", 3) == 0)
-		return (1);
-	if (ft_strncmp(cmd, "pwd", 4) == 0)
-		return (1);
-	if (ft_strncmp(cmd, "export", 7) == 0)
-		return (1);
-	if (ft_strncmp(cmd, "unset", 6) == 0)
-		return (1);
-	if (ft_strncmp(cmd, "env", 4) == 0)
-		return (1);
-	if (ft_strncmp(cmd, "exit", 5) == 0)
-		return (1);
-	return (0);
+	size_t	len;
+	int	id;
+
+	if (!name)
+		return (-1);
+	len = ft_strlen(name) + 1;
+	id = 0;
+	while (g_builtin_names[id]
+		&& ft_strncmp(g_builtin_names[id], name, len) != 0)
+		id++;
+	if (!g_builtin_names[id])
+		return (-1);
+	return (id);
 }
 
-static int	save_and_redirect(t_redir *redirs, int *saved_stdin, int *saved_stdout)
+// Name of builtin id, NULL past the last one
+const char	*builtin_name(int id)
 {
-	t_redir	*current;
-	int	fd;
+	return (g_builtin_names[id]);
+}
 
-	*saved_stdin = dup(STDIN_FILENO);
-	*saved_stdout = dup(STDOUT_FILENO);
-	
-	current = redirs;
-	while (current)
-	{
-		if (current->type == REDIR_OUT)
-		{
-			fd = open(current->file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-			if (fd == -1)
-			{
-				perror(current->file);
-				return (1);
-			}
-			if (dup2(fd, STDOUT_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
-            close(fd);
-        }
-		else if (current->type == REDIR_APPEND)
-		{
-			fd = open(current->file, O_WRONLY | O_CREAT | O_APPEND, 0644);
-			if (fd == -1)
-			{
-				perror(current->file);
-				return (1);
-			}
-			if (dup2(fd, STDOUT_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
-            close(fd);
-        }
-		else if (current->type == REDIR_IN)
-		{
-			fd = open(current->file, O_RDONLY);
-			if (fd == -1)
-			{
-				perror(current->file);
-				return (1);
-			}
-			if (dup2(fd, STDIN_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
-            close(fd);
-        }
-		current = current->next;
-	}
-	return (0);
+int	is_builtin(char *cmd)
+{
+	return (builtin_id(cmd) >= 0);
 }
 
-static void	restore_fds(int saved_stdin, int saved_stdout)
+static int	call_builtin(int id, char **args, t_env *env)
 {
-	dup2(saved_stdin, STDIN_FILENO);
-	dup2(saved_stdout, STDOUT_FILENO);
-	close(saved_stdin);
-	close(saved_stdout);
+	if (id == BI_ECHO)
+		return (builtin_echo(args));
+	if (id == BI_CD)
+		return (builtin_cd(args, env));
+	if (id == BI_PWD)
+		return (builtin_pwd(args));
+	if (id == BI_EXPORT)
+		return (builtin_export(args, env));
+	if (id == BI_UNSET)
+		return (builtin_unset(args, env));
+	if (id == BI_ENV)
+		return (builtin_env(args, env));
+	if (id == BI_EXIT)
+		return (builtin_exit(args));
+	if (id == BI_SET)
+		return (builtin_set(args));
+	if (id == BI_RETURN)
+		return (builtin_return(args));
+	if (id == BI_TEST || id == BI_BRACKET)
+		return (builtin_test(args));
+	if (id == BI_FALSE)
+		return (1);
+	if (id == BI_BREAK || id == BI_CONTINUE)
+		return (builtin_break(args));
+	if (id == BI_ALIAS)
+		return (builtin_alias(args));
+	if (id == BI_UNALIAS)
+		return (builtin_unalias(args));
+	if (id == BI_HISTORY)
+		return (builtin_history(args));
+	if (id == BI_PUSHD)
+		return (builtin_pushd(args, env));
+	if (id == BI_POPD)
+		return (builtin_popd(args, env));
+	if (id == BI_DIRS)
+		return (builtin_dirs(args, env));
+	return (0); // true and :
 }
 
-int	execute_builtin(t_simple_cmd *cmd, t_env *env)
+// Run builtin id with cmd's redirections applied
+int	run_builtin(int id, t_simple_cmd *cmd, t_env *env)
 {
-    int	saved_stdin;
-    int	saved_stdout;
-    int	result;
+	t_redir_state	state;
+	int		result;
 
-    if (!cmd->args || !cmd->args[0])
-        return (0);
-    
-    // Handle redirections for built-ins
-    if (cmd->redirs)
-    {
-        if (save_and_redirect(cmd->redirs, &saved_stdin, &saved_stdout) != 0)
-        {
-            // On redirection failure, restore any changed fds before returning
-            if (saved_stdin >= 0)
-                dup2(saved_stdin, STDIN_FILENO), close(saved_stdin);
-            if (saved_stdout >= 0)
-                dup2(saved_stdout, STDOUT_FILENO), close(saved_stdout);
-            return (1);
-        }
-    }
-	
-    // Execute the built-in command
-    if (ft_strncmp(cmd->args[0], "echo", 5) == 0)
-        result = builtin_echo(cmd->args);
-    else if (ft_strncmp(cmd->args[0], "cd", 3) == 0)
-        result = builtin_cd(cmd->args, env);
-	else if (ft_strncmp(cmd->args[0], "pwd", 4) == 0)
-		result = builtin_pwd();
-	else if (ft_strncmp(cmd->args[0], "export", 7) == 0)
-		result = builtin_export(cmd->args, env);
-	else if (ft_strncmp(cmd->args[0], "unset", 6) == 0)
-		result = builtin_unset(cmd->args, env);
-	else if (ft_strncmp(cmd->args[0], "env", 4) == 0)
-		result = builtin_env(env);
-	else if (ft_strncmp(cmd->args[0], "exit", 5) == 0)
-		result = builtin_exit(cmd->args);
-	else
-		result = 0;
-	
+	if (!cmd->args || !cmd->args[0])
+		return (0);
+	// Handle redirections for built-ins, undoing them on failure
+	if (apply_redirections(cmd->redirs, &state) != 0)
+	{
+		restore_redirections(&state);
+		return (1);
+	}
+	result = call_builtin(id, cmd->args, env);
+	// printf builtins must not be overtaken by echo's write(2) or a
+	// child when stdout is not a terminal
+	fflush(stdout);
 	// Restore original file descriptors
-	if (cmd->redirs)
-		restore_fds(saved_stdin, saved_stdout);
-	
+	restore_redirections(&state);
 	return (result);
 }
@@ -10,74 +10,128 @@
 /*                                                                            */
 /* ************************************************************************** */
 
-
 #include "builtins.h"
 #include <unistd.h>
 
-int	builtin_cd(char **args, t_env *env)
+// cd [-L|-P] [dir]. With -L, the default, dir is resolved against the
+// logical working directory as text and that path becomes $PWD. When
+// it cannot be entered, dir is left to the kernel to resolve (a `..`
+// right after a symlink), and $PWD comes from getcwd, as with -P.
+// A relative dir is first looked for along CDPATH (cdpath.c).
+
+// -L and -P of cd and pwd, the last one winning; the index of the first
+// operand, or -1 after a bad option
+int	parse_dir_options(char **args, const char *name, int *physical)
 {
-	char	*path;
-	char	*home;
-	char	*oldpwd;
-	char	*current_pwd;
+	int	i;
+	int	j;
 
-	// Check for too many arguments
-	if (args[1] && args[2])
+	*physical = 0;
+	i = 1;
+	while (args[i] && args[i][0] == '-' && args[i][1])
 	{
-		fprintf(stderr, "minishell: cd: too many arguments\n");
-		return (1);
-	}
-	
-	// Get current directory for OLDPWD
-	current_pwd = getcwd(NULL, 0);
-	
-	if (!args[1])
-	{
-		home = get_env_value(env, "HOME");
-		if (!home)
+		if (ft_strncmp(args[i], "--", 3) == 0)
+			return (i + 1);
+		j = 1;
+		while (args[i][j] == 'L' || args[i][j] == 'P')
+			*physical = (args[i][j++] == 'P');
+		if (args[i][j])
 		{
-			fprintf(stderr, "minishell: cd: HOME not set\n");
-			free(current_pwd);
-			return (1);
+			fprintf(stderr, "minishell: %s: -%c: invalid option\n", name,
+				args[i][j]);
+			fprintf(stderr, "%s: usage: %s %s\n", name, name,
+				name[0] == 'c' ? "[-L|-P] [dir]" : "[-LP]");
+			return (-1);
 		}
-		path = home;
+		i++;
 	}
-	else if (ft_strncmp(args[1], "-", 2) == 0 && !args[1][1])
+	return (i);
+}
+
+int	change_dir(const char *dir, int physical, t_env *env)
+{
+	t_shell	*shell;
+	char	*path;
+
+	shell = get_shell();
+	path = NULL;
+	if (!physical && (shell->pwd || *dir == '/'))
+		path = canon_path(shell->pwd ? shell->pwd : "/", dir);
+	if (path && chdir(path) == 0)
 	{
-		oldpwd = get_env_value(env, "OLDPWD");
-		if (!oldpwd)
-		{
-			fprintf(stderr, "minishell: cd: OLDPWD not set\n");
-			free(current_pwd);
-			return (1);
-		}
-		path = oldpwd;
-		printf("%s\n", path); // Print the directory we're going to
+		pwd_set(env, path);
+		return (0);
 	}
-	else
-		path = args[1];
-	
-	if (chdir(path) != 0)
+	free(path);
+	if (chdir(dir) != 0)
 	{
-		perror("cd");
-		free(current_pwd);
+		fprintf(stderr, "minishell: cd: %s: %s\n", dir, strerror(errno));
 		return (1);
 	}
-	
-	// Update OLDPWD and PWD
-	if (current_pwd)
+	pwd_set(env, getcwd(NULL, 0));
+	return (0);
+}
+
+// A directory operand of cd or pushd: looked for along CDPATH unless
+// its first component is `/`, `.` or `..`. *announce is set when
+// CDPATH supplied it, as cd then prints where it went.
+int	cd_to(const char *dir, int physical, t_env *env, int *announce)
+{
+	char	*path;
+	int	status;
+
+	path = NULL;
+	*announce = 0;
+	if (*dir != '/' && ft_strncmp(dir, ".", 2) && ft_strncmp(dir, "./", 2)
+		&& ft_strncmp(dir, "..", 3) && ft_strncmp(dir, "../", 3))
+		path = cdpath_find(dir, env, announce);
+	if (!path)
 	{
-		set_env_value(&env, "OLDPWD", current_pwd);
-		free(current_pwd);
+		*announce = 0;
+		return (change_dir(dir, physical, env));
 	}
-	
-	current_pwd = getcwd(NULL, 0);
-	if (current_pwd)
+	status = change_dir(path, physical, env);
+	free(path);
+	return (status);
+}
+
+int	builtin_cd(char **args, t_env *env)
+{
+	const char	*dir;
+	int		physical;
+	int		announce;
+	int		status;
+	int		i;
+
+	i = parse_dir_options(args, "cd", &physical);
+	if (i < 0)
+		return (2);
+	if (args[i] && args[i + 1])
 	{
-		set_env_value(&env, "PWD", current_pwd);
-		free(current_pwd);
+		fprintf(stderr, "minishell: cd: too many arguments\n");
+		return (1);
+	}
+	dir = args[i];
+	if (!dir)
+		dir = get_env_value(env, "HOME");
+	else if (ft_strncmp(dir, "-", 2) == 0)
+		dir = get_env_value(env, "OLDPWD");
+	if (!dir)
+	{
+		fprintf(stderr, "minishell: cd: %s not set\n",
+			args[i] ? "OLDPWD" : "HOME");
+		return (1);
 	}
-	
+	if (!*dir)
+		return (0);
+	announce = (args[i] && ft_strncmp(args[i], "-", 2) == 0);
+	if (announce || !args[i])
+		status = change_dir(dir, physical, env);
+	else
+		status = cd_to(dir, physical, env, &announce);
+	if (status != 0)
+		return (1);
+	if (announce && get_shell()->pwd)
+		printf("%s\n", get_shell()->pwd); // where `cd -' or CDPATH went
 	return (0);
 }
-
@@ -0,0 +1,257 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   cdpath.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 00:52:08 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 00:52:10 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+
+// CDPATH. For a name found under one of its absolute entries, the index
+// of that entry is remembered, so the next `cd name` stats only the
+// directory it goes to instead of every candidate before it. Entries
+// relative to the working directory, `.` among them, are looked at
+// every time. A remembered directory that is gone is searched for
+// again, and everything is forgotten when CDPATH changes or, checked
+// once per prompt, the mtime of one of its absolute entries does: a
+// directory made in an earlier entry must win over the remembered one.
+
+#define CDPATH_SLOTS 64
+#define CDPATH_MAX_HITS 256
+
+typedef struct s_cd_hit
+{
+	char		*name;	// name and next as in t_named
+	struct s_cd_hit	*next;
+	int		entry;
+}	t_cd_hit;
+
+typedef struct s_cd_cache
+{
+	char		*cdpath;	// the CDPATH the hits are for
+	struct timespec	*mtimes;	// of each entry, when absolute
+	int		entries;
+	int		checked;	// mtimes compared since the last prompt
+	t_cd_hit	*slots[CDPATH_SLOTS];
+	int		count;
+}	t_cd_cache;
+
+static t_cd_cache	g_cd;
+
+static t_named	**slot(const char *name)
+{
+	return ((t_named **)&g_cd.slots[hash_text(name) % CDPATH_SLOTS]);
+}
+
+static void	forget_all(void)
+{
+	t_cd_hit	*next;
+	int		i;
+
+	i = 0;
+	while (i < CDPATH_SLOTS)
+	{
+		while (g_cd.slots[i])
+		{
+			next = g_cd.slots[i]->next;
+			free(g_cd.slots[i]->name);
+			free(g_cd.slots[i]);
+			g_cd.slots[i] = next;
+		}
+		i++;
+	}
+	g_cd.count = 0;
+}
+
+// The cached hit for name, or NULL; with drop, it is also removed
+static t_cd_hit	*find_hit(const char *name, int drop)
+{
+	t_named		**link;
+	t_cd_hit	*hit;
+
+	link = named_link(slot(name), name);
+	hit = (t_cd_hit *)*link;
+	if (hit && drop)
+	{
+		*link = (*link)->next;
+		free(hit->name);
+		free(hit);
+		g_cd.count--;
+		return (NULL);
+	}
+	return (hit);
+}
+
+static void	remember(const char *name, int entry)
+{
+	t_cd_hit	*hit;
+
+	if (g_cd.count >= CDPATH_MAX_HITS)
+		forget_all();
+	hit = malloc(sizeof(t_cd_hit));
+	if (!hit)
+		return ;
+	hit->name = ft_strdup(name);
+	if (!hit->name)
+	{
+		free(hit);
+		return ;
+	}
+	hit->entry = entry;
+	hit->next = (t_cd_hit *)*slot(name);
+	*slot(name) = (t_named *)hit;
+	g_cd.count++;
+}
+
+// Whether the absolute entries of CDPATH kept their mtimes; refreshes
+// them. Only the first call after a prompt looks.
+static int	unchanged(void)
+{
+	struct stat	st;
+	const char	*at;
+	char		*entry;
+	size_t		len;
+	int		same;
+	int		i;
+
+	if (g_cd.checked)
+		return (1);
+	g_cd.checked = 1;
+	same = 1;
+	at = g_cd.cdpath;
+	i = 0;
+	while (i < g_cd.entries)
+	{
+		len = 0;
+		while (at[len] && at[len] != ':')
+			len++;
+		entry = ft_substr(at, 0, len);
+		ft_bzero(&st, sizeof(st));
+		if (entry && *entry == '/')
+			stat(entry, &st);
+		free(entry);
+		same = same && st.st_mtim.tv_sec == g_cd.mtimes[i].tv_sec
+			&& st.st_mtim.tv_nsec == g_cd.mtimes[i].tv_nsec;
+		g_cd.mtimes[i++] = st.st_mtim;
+		at += len + (at[len] == ':');
+	}
+	return (same);
+}
+
+// Start over for a new CDPATH
+static void	reset(const char *cdpath)
+{
+	int	i;
+
+	forget_all();
+	free(g_cd.cdpath);
+	free(g_cd.mtimes);
+	g_cd.entries = 1;
+	i = 0;
+	while (cdpath[i])
+		g_cd.entries += (cdpath[i++] == ':');
+	g_cd.cdpath = ft_strdup(cdpath);
+	g_cd.mtimes = ft_calloc(g_cd.entries, sizeof(struct timespec));
+	g_cd.checked = 0;
+	if (!g_cd.cdpath || !g_cd.mtimes)
+	{
+		free(g_cd.cdpath);
+		free(g_cd.mtimes);
+		g_cd.cdpath = NULL;
+		g_cd.mtimes = NULL;
+	}
+}
+
+// Next prompt: the entries' mtimes are compared again
+void	cdpath_expire(void)
+{
+	g_cd.checked = 0;
+}
+
+// entry/dir, or dir alone for an empty entry
+static char	*candidate(const char *entry, size_t len, const char *dir)
+{
+	char	*path;
+	size_t	dir_len;
+
+	dir_len = ft_strlen(dir);
+	path = malloc(len + dir_len + 2);
+	if (!path)
+		return (NULL);
+	ft_memcpy(path, entry, len);
+	if (len && entry[len - 1] != '/')
+		path[len++] = '/';
+	ft_memcpy(path + len, dir, dir_len + 1);
+	return (path);
+}
+
+// Whether dir is what the entry of CDPATH at *at makes of it; moves
+// *at past the entry. *path gets the candidate when it is.
+static int	try_entry(const char **at, const char *dir, int skip, char **path)
+{
+	struct stat	st;
+	const char	*entry;
+	size_t		len;
+
+	entry = *at;
+	len = 0;
+	while (entry[len] && entry[len] != ':')
+		len++;
+	*at = entry + len + (entry[len] == ':');
+	if (!entry[len])
+		*at = NULL;
+	*path = NULL;
+	if (skip && len && *entry == '/')
+		return (0);
+	*path = candidate(entry, len, dir);
+	if (*path && stat(*path, &st) == 0 && S_ISDIR(st.st_mode))
+		return (1);
+	free(*path);
+	*path = NULL;
+	return (0);
+}
+
+// The directory CDPATH makes of dir, as a new string, or NULL to take
+// dir as it is. *announce is set when it came from a non-empty entry,
+// so that cd prints where it went.
+char	*cdpath_find(const char *dir, t_env *env, int *announce)
+{
+	const char	*at;
+	t_cd_hit	*hit;
+	char		*path;
+	int		i;
+
+	at = get_env_value(env, "CDPATH");
+	if (!at || !*at)
+		return (NULL);
+	if (!g_cd.cdpath || ft_strncmp(g_cd.cdpath, at, ft_strlen(at) + 1))
+		reset(at);
+	if (g_cd.cdpath && !unchanged())
+		forget_all();
+	hit = NULL;
+	if (g_cd.cdpath)
+		hit = find_hit(dir, 0);
+	i = 0;
+	while (at)
+	{
+		*announce = (*at && *at != ':');
+		if (try_entry(&at, dir, hit && hit->entry != i, &path))
+		{
+			if (!hit && *path == '/' && g_cd.cdpath)
+				remember(dir, i);
+			return (path);
+		}
+		if (hit && hit->entry == i)
+		{
+			find_hit(dir, 1);
+			return (cdpath_find(dir, env, announce));
+		}
+		i++;
+	}
+	return (NULL);
+}
@@ -0,0 +1,321 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   dirs.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 01:04:27 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 01:04:29 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+
+// The directory stack of pushd, popd and dirs. Entry 0 is always the
+// working directory, so only the entries below it are kept here, the
+// most recently pushed first.
+
+typedef struct s_dirstack
+{
+	char	**dirs;
+	int	count;
+	int	cap;
+}	t_dirstack;
+
+static t_dirstack	g_stack;
+
+// Entry i of the whole stack
+static const char	*stack_entry(int i)
+{
+	if (i > 0)
+		return (g_stack.dirs[i - 1]);
+	if (get_shell()->pwd)
+		return (get_shell()->pwd);
+	return (".");
+}
+
+// Put dir, which is taken over, at index at of the kept entries
+static int	insert(int at, char *dir)
+{
+	char	**grown;
+
+	if (!dir)
+		return (1);
+	if (g_stack.count == g_stack.cap)
+	{
+		g_stack.cap = g_stack.cap * 2 + 8;
+		grown = malloc(sizeof(char *) * g_stack.cap);
+		if (!grown)
+		{
+			free(dir);
+			return (1);
+		}
+		if (g_stack.dirs)
+			ft_memcpy(grown, g_stack.dirs, sizeof(char *) * g_stack.count);
+		free(g_stack.dirs);
+		g_stack.dirs = grown;
+	}
+	ft_memmove(g_stack.dirs + at + 1, g_stack.dirs + at,
+		sizeof(char *) * (g_stack.count - at));
+	g_stack.dirs[at] = dir;
+	g_stack.count++;
+	return (0);
+}
+
+static void	remove_at(int at)
+{
+	free(g_stack.dirs[at]);
+	g_stack.count--;
+	ft_memmove(g_stack.dirs + at, g_stack.dirs + at + 1,
+		sizeof(char *) * (g_stack.count - at));
+}
+
+// +N counts from the top of the stack, -N from the bottom. Returns 0
+// when arg is not of that form; *index is -1 when it is out of range.
+static int	stack_index(const char *arg, int *index)
+{
+	int	i;
+
+	if (arg[0] != '+' && arg[0] != '-')
+		return (0);
+	i = 1;
+	while (ft_isdigit(arg[i]))
+		i++;
+	if (i == 1 || i > 10 || arg[i])
+		return (0);
+	*index = ft_atoi(arg + 1);
+	if (arg[0] == '-')
+		*index = g_stack.count - *index;
+	if (*index < 0 || *index > g_stack.count)
+		*index = -1;
+	return (1);
+}
+
+static int	index_error(const char *name, const char *arg)
+{
+	if (g_stack.count == 0)
+		fprintf(stderr, "minishell: %s: directory stack empty\n", name);
+	else
+		fprintf(stderr, "minishell: %s: %s: directory stack index out of "
+			"range\n", name, arg);
+	return (1);
+}
+
+// dir, with $HOME shown as ~ unless full
+static void	print_dir(const char *dir, int full, t_env *env)
+{
+	char	*home;
+	size_t	len;
+
+	home = get_env_value(env, "HOME");
+	if (!full && home && *home)
+	{
+		len = ft_strlen(home);
+		if (ft_strncmp(dir, home, len) == 0
+			&& (dir[len] == '/' || dir[len] == '\0'))
+		{
+			printf("~%s", dir + len);
+			return ;
+		}
+	}
+	printf("%s", dir);
+}
+
+// Flags: 'l' full paths, 'p' one per line, 'v' one per line numbered
+static void	print_stack(const char *flags, t_env *env)
+{
+	int	i;
+
+	i = 0;
+	while (i <= g_stack.count)
+	{
+		if (ft_strchr(flags, 'v'))
+			printf("%2d  ", i);
+		print_dir(stack_entry(i), ft_strchr(flags, 'l') != NULL, env);
+		if (ft_strchr(flags, 'v') || ft_strchr(flags, 'p'))
+			printf("\n");
+		else
+			printf("%s", i < g_stack.count ? " " : "\n");
+		i++;
+	}
+}
+
+// Add the letters of option arg to flags; 0 when it is not one of dirs
+static int	add_flags(const char *arg, char *flags)
+{
+	int	i;
+
+	if (arg[0] != '-' || !arg[1])
+		return (0);
+	i = 1;
+	while (arg[i] && ft_strchr("clpv", arg[i]))
+	{
+		if (!ft_strchr(flags, arg[i]))
+			flags[ft_strlen(flags)] = arg[i];
+		i++;
+	}
+	return (arg[i] == '\0');
+}
+
+// dirs [-clpv] [+N|-N]
+int	builtin_dirs(char **args, t_env *env)
+{
+	char	flags[5];
+	int	index;
+	int	i;
+
+	ft_bzero(flags, sizeof(flags));
+	index = -1;
+	i = 1;
+	while (args[i])
+	{
+		if (stack_index(args[i], &index))
+		{
+			if (index < 0)
+				return (index_error("dirs", args[i]));
+		}
+		else if (!add_flags(args[i], flags))
+		{
+			fprintf(stderr, "minishell: dirs: %s: invalid option\n"
+				"dirs: usage: dirs [-clpv] [+N] [-N]\n", args[i]);
+			return (1);
+		}
+		i++;
+	}
+	if (ft_strchr(flags, 'c'))
+	{
+		while (g_stack.count > 0)
+			remove_at(g_stack.count - 1);
+		return (0);
+	}
+	if (index < 0)
+		print_stack(flags, env);
+	else
+	{
+		print_dir(stack_entry(index), ft_strchr(flags, 'l') != NULL, env);
+		printf("\n");
+	}
+	return (0);
+}
+
+// pushd +N: cd to entry N, turning the stack so that it is on top
+static int	rotate(int n, t_env *env)
+{
+	char	**turned;
+	char	*here;
+	int	k;
+
+	here = ft_strdup(stack_entry(0));
+	turned = malloc(sizeof(char *) * (g_stack.count + 1));
+	if (!here || !turned || change_dir(stack_entry(n), 0, env) != 0)
+	{
+		free(here);
+		free(turned);
+		return (1);
+	}
+	k = 0;
+	while (k++ < g_stack.count)
+	{
+		if ((n + k) % (g_stack.count + 1) == 0)
+			turned[k - 1] = here;
+		else
+			turned[k - 1] = g_stack.dirs[(n + k) % (g_stack.count + 1) - 1];
+	}
+	free(g_stack.dirs[n - 1]);
+	free(g_stack.dirs);
+	g_stack.dirs = turned;
+	g_stack.cap = g_stack.count + 1;
+	return (0);
+}
+
+// pushd alone: swap the top two entries
+static int	swap_top(t_env *env)
+{
+	char	*here;
+
+	if (g_stack.count == 0)
+	{
+		fprintf(stderr, "minishell: pushd: no other directory\n");
+		return (1);
+	}
+	here = ft_strdup(stack_entry(0));
+	if (!here || change_dir(g_stack.dirs[0], 0, env) != 0)
+	{
+		free(here);
+		return (1);
+	}
+	free(g_stack.dirs[0]);
+	g_stack.dirs[0] = here;
+	return (0);
+}
+
+// pushd [-n] [dir | +N | -N]: cd to dir and push the directory left,
+// or rotate the stack. With -n, dir is pushed under the top and the
+// working directory stays.
+int	builtin_pushd(char **args, t_env *env)
+{
+	char	*here;
+	int	announce;
+	int	index;
+	int	i;
+
+	i = 1 + (args[1] && ft_strncmp(args[1], "-n", 3) == 0);
+	if (args[i] && args[i + 1])
+	{
+		fprintf(stderr, "minishell: pushd: too many arguments\n");
+		return (1);
+	}
+	if (!args[i] && swap_top(env) != 0)
+		return (1);
+	if (args[i] && stack_index(args[i], &index))
+	{
+		if (index < 0)
+			return (index_error("pushd", args[i]));
+		if (index > 0 && rotate(index, env) != 0)
+			return (1);
+	}
+	else if (args[i] && i == 2 && insert(0, ft_strdup(args[i])) != 0)
+		return (1);
+	else if (args[i] && i == 1)
+	{
+		here = ft_strdup(stack_entry(0));
+		if (!here || cd_to(args[i], 0, env, &announce) != 0)
+		{
+			free(here);
+			return (1);
+		}
+		insert(0, here);
+	}
+	print_stack("", env);
+	return (0);
+}
+
+// popd [-n] [+N | -N]: drop entry N, the top by default, going to the
+// next one when that is the working directory (unless -n)
+int	builtin_popd(char **args, t_env *env)
+{
+	int	index;
+	int	i;
+
+	i = 1 + (args[1] && ft_strncmp(args[1], "-n", 3) == 0);
+	index = 0;
+	if (args[i] && !stack_index(args[i], &index))
+	{
+		fprintf(stderr, "minishell: popd: %s: invalid argument\n"
+			"popd: usage: popd [-n] [+N | -N]\n", args[i]);
+		return (1);
+	}
+	if (index < 0 || g_stack.count == 0)
+		return (index_error("popd", args[i]));
+	if (args[i] && args[i + 1])
+	{
+		fprintf(stderr, "minishell: popd: too many arguments\n");
+		return (1);
+	}
+	if (index == 0 && i == 1 && change_dir(g_stack.dirs[0], 0, env) != 0)
+		return (1);
+	remove_at(index - (index > 0));
+	print_stack("", env);
+	return (0);
+}
@@ -13,46 +13,70 @@
 
 #include "builtins.h"
 
-static void	print_with_escape(char *str, int interpret_escapes)
+#define ECHO_BUF 4096
+
+// Output is collected here and written in large chunks instead of one
+// write() per character
+typedef struct s_outbuf
+{
+    char	data[ECHO_BUF];
+    size_t	len;
+}	t_outbuf;
+
+static void	out_flush(t_outbuf *out)
 {
-    int	i;
+    if (out->len)
+        write(STDOUT_FILENO, out->data, out->len);
+    out->len = 0;
+}
 
-    i = 0;
-    while (str[i])
+static void	out_put(t_outbuf *out, const char *s, size_t n)
+{
+    if (out->len + n > ECHO_BUF)
+        out_flush(out);
+    if (n >= ECHO_BUF)
     {
-        if (interpret_escapes && str[i] == '\\' && str[i + 1])
-        {
-            i++;
-            if (str[i] == 'n')
-                write(STDOUT_FILENO, "\n", 1);
-            else if (str[i] == 't')
-                write(STDOUT_FILENO, "\t", 1);
-            else if (str[i] == 'r')
-                write(STDOUT_FILENO, "\r", 1);
-            else if (str[i] == 'b')
-                write(STDOUT_FILENO, "\b", 1);
-            else if (str[i] == 'a')
-                write(STDOUT_FILENO, "\a", 1);
-            else if (str[i] == 'v')
-                write(STDOUT_FILENO, "\v", 1);
-            else if (str[i] == 'f')
-                write(STDOUT_FILENO, "\f", 1);
-            else if (str[i] == '\\')
-                write(STDOUT_FILENO, "\\", 1);
-            else
-            {
-                char buf[2] = {'\\', 0};
-                write(STDOUT_FILENO, buf, 1);
-                buf[0] = str[i];
-                write(STDOUT_FILENO, buf, 1);
-            }
-        }
+        write(STDOUT_FILENO, s, n);
+        return ;
+    }
+    ft_memcpy(out->data + out->len, s, n);
+    out->len += n;
+}
+
+// The character \c stands for with -e, or 0 when it is not an escape
+static char	escape_char(char c)
+{
+    const char	*from = "ntrbavf\\";
+    const char	*to = "\n\t\r\b\a\v\f\\";
+    int			k;
+
+    k = 0;
+    while (from[k] && from[k] != c)
+        k++;
+    return (to[k]);
+}
+
+static void	print_with_escape(t_outbuf *out, char *str, int interpret_escapes)
+{
+    size_t	run;
+    char	c;
+
+    while (*str)
+    {
+        run = 0;
+        while (str[run] && !(interpret_escapes && str[run] == '\\'
+                && str[run + 1]))
+            run++;
+        out_put(out, str, run);
+        str += run;
+        if (!*str)
+            break ;
+        c = escape_char(str[1]);
+        if (c)
+            out_put(out, &c, 1);
         else
-        {
-            char c = str[i];
-            write(STDOUT_FILENO, &c, 1);
-        }
-        i++;
+            out_put(out, str, 2);
+        str += 2;
     }
 }
 
@@ -81,12 +105,13 @@ int	builtin_echo(char **args)
 	int	newline;
 	int	first_arg;
 	int	interpret_escapes;
-
+	t_outbuf	out;
 
 	newline = 1;
 	interpret_escapes = 0;
 	i = 1;
 	first_arg = 1;
+	out.len = 0;
 	
     // Check for flags. Accept -n, -nnn... as -n (suppress newline)
     while (args[i] && args[i][0] == '-')
@@ -109,15 +134,16 @@ int	builtin_echo(char **args)
     while (args[i])
     {
         if (!first_arg)
-            write(STDOUT_FILENO, " ", 1);
-        print_with_escape(args[i], interpret_escapes);
+            out_put(&out, " ", 1);
+        print_with_escape(&out, args[i], interpret_escapes);
         first_arg = 0;
         i++;
     }
 	
     // Always print newline unless -n flag is present
     if (newline)
-        write(STDOUT_FILENO, "\n", 1);
+        out_put(&out, "\n", 1);
+    out_flush(&out);
 
     return (0);
 }
@@ -12,18 +12,39 @@
 
 
 #include "builtins.h"
+#include "executor.h"
 
-int	builtin_env(t_env *env)
+// env [NAME=value]... [command [args]...]: print the exported
+// variables, or run command, with the assignments laid over them
+int	builtin_env(char **args, t_env *env)
 {
-	t_env	*current;
+	char	**assigns;
+	char	**base;
+	char	**envp;
+	int	status;
+	int	n;
 
-	current = env;
-	while (current)
+	n = 1;
+	while (args[n] && is_assignment(args[n]))
+		n++;
+	assigns = ft_calloc(n, sizeof(char *));
+	if (!assigns)
+		return (125);
+	ft_memcpy(assigns, args + 1, sizeof(char *) * (n - 1));
+	if (args[n])
+		status = execute_env_command(args + n, assigns, env);
+	else
 	{
-		printf("%s=%s\n", current->key, current->value);
-		current = current->next;
+		base = get_envp();
+		envp = NULL;
+		if (base)
+			envp = envp_overlay(base, assigns);
+		status = (envp == NULL);
+		n = 0;
+		while (envp && envp[n])
+			printf("%s\n", envp[n++]);
+		free(envp);
 	}
-	
-	return (0);
+	free(assigns);
+	return (status);
 }
-
@@ -12,6 +12,7 @@
 
 
 #include "builtins.h"
+#include "history.h"
 
 static int	is_valid_number(char *str)
 {
@@ -37,7 +38,9 @@ int	builtin_exit(char **args)
 {
 	int	exit_code;
 
-	printf("exit\n");
+	input_sync(); // leave the rest of a script file to whoever reads on
+	if (get_shell()->interactive)
+		fprintf(stderr, "exit\n");
 	
 	if (!args[1])
 	{
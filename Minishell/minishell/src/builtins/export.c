@@ -16,15 +16,17 @@
 void	set_env_value(t_env **env, char *key, char *value){
 	t_env	*current;
 	t_env	*new_node;
+	size_t	len;
 
+	len = ft_strlen(key) + 1;
 	current = *env;
 	while (current)
 	{
-		if (ft_strncmp(current->key, key, ft_strlen(key)) == 0 &&
-		    ft_strlen(current->key) == ft_strlen(key))
+		if (ft_strncmp(current->key, key, len) == 0)
 		{
 			free(current->value);
 			current->value = ft_strdup(value);
+			var_changed(current);
 			return ;
 		}
 		current = current->next;
@@ -37,6 +39,8 @@ void	set_env_value(t_env **env, char *key, char *value){
         return ;
     new_node->key = ft_strdup(key);
     new_node->value = ft_strdup(value);
+    new_node->exported = 0; // `export` moves it to the exported tier
+    new_node->entry = NULL;
     new_node->next = NULL;
 
     // Append to tail (assumes *env is not NULL as environment is initialized)
@@ -77,6 +81,19 @@ static int	is_valid_identifier(char *str)
 	return (1);
 }
 
+// Put the variable key into the exported tier, or with `export -n`
+// take it out
+static void	set_tier(t_env *env, char *key, int unexport)
+{
+	t_env	*var;
+
+	var = find_env(env, key);
+	if (var && unexport)
+		unexport_var(var);
+	else if (var)
+		export_var(var);
+}
+
 int	builtin_export(char **args, t_env *env)
 {
 	char	*equal_pos;
@@ -84,6 +101,7 @@ int	builtin_export(char **args, t_env *env)
 	char	*value;
 	int	i;
 	int	exit_status;
+	int	unexport;
 
 	if (!args[1])
 	{
@@ -91,7 +109,9 @@ int	builtin_export(char **args, t_env *env)
 		t_env *current = env;
 		while (current)
 		{
-			printf("declare -x %s=\"%s\"\n", current->key, current->value);
+			if (current->exported)
+				printf("declare -x %s=\"%s\"\n", current->key,
+					current->value);
 			current = current->next;
 		}
 		return (0);
@@ -99,6 +119,9 @@ int	builtin_export(char **args, t_env *env)
 	
 	exit_status = 0;
 	i = 1;
+	unexport = (ft_strncmp(args[1], "-n", 3) == 0);
+	if (unexport)
+		i++;
 	while (args[i])
 	{
 		equal_pos = ft_strchr(args[i], '=');
@@ -115,6 +138,7 @@ int	builtin_export(char **args, t_env *env)
 			else if (key && value)
 			{
 				set_env_value(&env, key, value);
+				set_tier(env, key, unexport);
 			}
 			free(key);
 			free(value);
@@ -129,7 +153,10 @@ int	builtin_export(char **args, t_env *env)
 			}
 			else
 			{
-				set_env_value(&env, args[i], "");
+				// An existing shell variable keeps its value
+				if (!find_env(env, args[i]) && !unexport)
+					set_env_value(&env, args[i], "");
+				set_tier(env, args[i], unexport);
 			}
 		}
 		i++;
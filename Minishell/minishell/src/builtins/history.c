@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   history.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:02:19 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:02:21 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+#include "history.h"
+
+// history [n] lists the last n entries (all by default) with their
+// numbers; history -c forgets them.
+int	builtin_history(char **args)
+{
+	int	first;
+	int	i;
+
+	if (args[1] && ft_strncmp(args[1], "-c", 3) == 0 && !args[2])
+	{
+		history_clear();
+		return (0);
+	}
+	if (args[1] && args[2])
+	{
+		fprintf(stderr, "minishell: history: too many arguments\n");
+		return (1);
+	}
+	first = 0;
+	if (args[1])
+	{
+		i = 0;
+		while (ft_isdigit(args[1][i]))
+			i++;
+		if (i == 0 || i > 9 || args[1][i])
+		{
+			fprintf(stderr, "minishell: history: %s: numeric argument "
+				"required\n", args[1]);
+			return (1);
+		}
+		if (ft_atoi(args[1]) < history_count())
+			first = history_count() - ft_atoi(args[1]);
+	}
+	while (first < history_count())
+	{
+		printf("%5ld  %s\n", history_number(first), history_entry(first));
+		first++;
+	}
+	return (0);
+}
@@ -13,10 +13,20 @@
 #include "builtins.h"
 #include <unistd.h>
 
-int	builtin_pwd(void)
+// pwd [-L|-P]: the logical directory cd keeps, with no system call; -P,
+// or a directory that was never known, asks the kernel
+int	builtin_pwd(char **args)
 {
 	char	*cwd;
+	int	physical;
 
+	if (parse_dir_options(args, "pwd", &physical) < 0)
+		return (2);
+	if (!physical && get_shell()->pwd)
+	{
+		printf("%s\n", get_shell()->pwd);
+		return (0);
+	}
 	cwd = getcwd(NULL, 0);
 	if (!cwd)
 	{
@@ -28,4 +38,3 @@ int	builtin_pwd(void)
 	free(cwd);
 	return (0);
 }
-
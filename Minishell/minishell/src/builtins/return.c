@@ -0,0 +1,42 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   return.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 20:07:51 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 20:07:53 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+
+// return [n]: leave the running function with status n, or with the
+// status of the last command. The executor stops running the lists of
+// the function body while shell->returning is set.
+int	builtin_return(char **args)
+{
+	char	*end;
+	long	status;
+
+	if (get_shell()->func_depth == 0)
+	{
+		fprintf(stderr, "minishell: return: can only `return' from a "
+			"function\n");
+		return (2);
+	}
+	status = get_shell()->last_status;
+	if (args[1])
+	{
+		status = strtol(args[1], &end, 10);
+		if (end == args[1] || *end)
+		{
+			fprintf(stderr, "minishell: return: %s: numeric argument "
+				"required\n", args[1]);
+			status = 2;
+		}
+	}
+	get_shell()->returning = 1;
+	return ((unsigned char)status);
+}
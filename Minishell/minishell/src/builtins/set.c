@@ -0,0 +1,162 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   set.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:20:51 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:20:53 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+
+typedef struct s_optname
+{
+	const char	*name;
+	int		flag;
+}	t_optname;
+
+static const t_optname	g_options[] = {
+	{"lastpipe", OPT_LASTPIPE},
+	{"noclobber", OPT_NOCLOBBER},
+	{"fdtrace", OPT_FDTRACE},
+	{"optimize", OPT_OPTIMIZE},
+	{"explain", OPT_EXPLAIN},
+	{"multios", OPT_MULTIOS},
+	{"argbatch", OPT_ARGBATCH},
+	{NULL, 0}
+};
+
+static void	print_options(void)
+{
+	int	i;
+
+	i = 0;
+	while (g_options[i].name)
+	{
+		printf("%-15s\t%s\n", g_options[i].name,
+			(get_shell()->options & g_options[i].flag) ? "on" : "off");
+		i++;
+	}
+	if (get_shell()->pipe_size)
+		printf("%-15s\t%d\n", "pipesize", get_shell()->pipe_size);
+	else
+		printf("%-15s\t%s\n", "pipesize", "default");
+	printf("%-15s\t%d\n", "batchjobs", get_shell()->batch_jobs
+		? get_shell()->batch_jobs : 1);
+}
+
+// Byte count with an optional k or m suffix. Returns -1 if malformed.
+static long	parse_size(const char *str)
+{
+	long	size;
+	int	i;
+
+	size = 0;
+	i = 0;
+	if (!ft_isdigit(str[0]))
+		return (-1);
+	while (ft_isdigit(str[i]))
+	{
+		size = size * 10 + (str[i++] - '0');
+		if (size > 1L << 30)
+			return (-1);
+	}
+	if (str[i] == 'k' || str[i] == 'K')
+		size <<= 10;
+	else if (str[i] == 'm' || str[i] == 'M')
+		size <<= 20;
+	else if (str[i])
+		return (-1);
+	if (str[i] && str[i + 1])
+		return (-1);
+	return (size > 1L << 30 ? -1 : size);
+}
+
+// pipesize=N: capacity requested for every pipeline pipe (0 = default)
+// batchjobs=N: argbatch batches run at the same time (0 = one)
+static int	set_number(char *name, int enable, size_t len, int *value)
+{
+	long	size;
+
+	if (!enable || !name[len])
+	{
+		*value = 0;
+		return (0);
+	}
+	size = parse_size(name + len + 1);
+	if (name[len] != '=' || size < 0)
+	{
+		fprintf(stderr, "minishell: set: %s: invalid size\n", name);
+		return (1);
+	}
+	*value = (int)size;
+	return (0);
+}
+
+static int	set_option(char *name, int enable)
+{
+	int	i;
+
+	if (ft_strncmp(name, "pipesize", 8) == 0
+		&& (name[8] == '\0' || name[8] == '='))
+		return (set_number(name, enable, 8, &get_shell()->pipe_size));
+	if (ft_strncmp(name, "batchjobs", 9) == 0
+		&& (name[9] == '\0' || name[9] == '='))
+		return (set_number(name, enable, 9, &get_shell()->batch_jobs));
+	i = 0;
+	while (g_options[i].name)
+	{
+		if (ft_strncmp(name, g_options[i].name,
+				ft_strlen(g_options[i].name) + 1) == 0)
+		{
+			if (enable)
+				get_shell()->options |= g_options[i].flag;
+			else
+				get_shell()->options &= ~g_options[i].flag;
+			return (0);
+		}
+		i++;
+	}
+	fprintf(stderr, "minishell: set: %s: invalid option name\n", name);
+	return (1);
+}
+
+// set -o           list options
+// set -o name      enable an option
+// set +o name      disable an option
+// set -o pipesize=N / set +o pipesize
+// set -o batchjobs=N / set +o batchjobs
+int	builtin_set(char **args)
+{
+	int	i;
+	int	status;
+
+	if (!args[1])
+		return (0);
+	status = 0;
+	i = 1;
+	while (args[i])
+	{
+		if ((ft_strncmp(args[i], "-o", 3) == 0
+				|| ft_strncmp(args[i], "+o", 3) == 0))
+		{
+			if (!args[i + 1])
+			{
+				if (args[i][0] == '-')
+					print_options();
+				return (status);
+			}
+			status |= set_option(args[i + 1], args[i][0] == '-');
+			i += 2;
+		}
+		else
+		{
+			fprintf(stderr, "minishell: set: %s: invalid option\n", args[i]);
+			return (2);
+		}
+	}
+	return (status);
+}
@@ -0,0 +1,285 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   test.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:04:12 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:04:15 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "builtins.h"
+#include <sys/stat.h>
+
+// test expr / [ expr ]: the POSIX rules by argument count, so that
+// `[ "$x" = -n ]` means what it says whatever $x holds. Longer
+// expressions, and those joined by -a/-o, are parsed by precedence:
+// `!` binds tighter than -a, -a tighter than -o. Status 0 when true,
+// 1 when false, 2 on a usage error.
+
+static const char	*g_name = "test"; // or "[", for messages
+
+// Cursor over the arguments of a parsed expression
+typedef struct s_expr
+{
+	char	**av;
+	int	n;
+	int	pos;
+}	t_expr;
+
+static int	test_error(const char *what, const char *msg)
+{
+	if (what)
+		fprintf(stderr, "minishell: %s: %s: %s\n", g_name, what, msg);
+	else
+		fprintf(stderr, "minishell: %s: %s\n", g_name, msg);
+	return (2);
+}
+
+static int	is_op(const char *word, const char *op)
+{
+	return (ft_strncmp(word, op, ft_strlen(op) + 1) == 0);
+}
+
+// -X file or -X string; -1 when op is not a unary operator
+static int	unary(const char *op, const char *arg)
+{
+	struct stat	st;
+
+	if (op[0] != '-' || !op[1] || op[2])
+		return (-1);
+	if (op[1] == 'n' || op[1] == 'z')
+		return ((arg[0] == '\0') == (op[1] == 'n'));
+	if (!ft_strchr("efdrwxs", op[1]))
+		return (-1);
+	if (op[1] == 'r' || op[1] == 'w' || op[1] == 'x')
+	{
+		if (op[1] == 'r')
+			return (access(arg, R_OK) != 0);
+		if (op[1] == 'w')
+			return (access(arg, W_OK) != 0);
+		return (access(arg, X_OK) != 0);
+	}
+	if (stat(arg, &st) != 0)
+		return (1);
+	if (op[1] == 'f')
+		return (!S_ISREG(st.st_mode));
+	if (op[1] == 'd')
+		return (!S_ISDIR(st.st_mode));
+	if (op[1] == 's')
+		return (st.st_size == 0);
+	return (0);
+}
+
+static int	to_integer(const char *s, long *n)
+{
+	char	*end;
+
+	while (*s == ' ' || *s == '\t')
+		s++;
+	*n = strtol(s, &end, 10);
+	while (*end == ' ' || *end == '\t')
+		end++;
+	if (end == s || *end)
+		return (0);
+	return (1);
+}
+
+// a OP b; -1 when op is not a binary operator
+static int	binary(const char *a, const char *op, const char *b)
+{
+	long	x;
+	long	y;
+
+	if (is_op(op, "="))
+		return (ft_strncmp(a, b, ft_strlen(a) + 1) != 0);
+	if (is_op(op, "!="))
+		return (ft_strncmp(a, b, ft_strlen(a) + 1) == 0);
+	if (!is_op(op, "-eq") && !is_op(op, "-ne") && !is_op(op, "-lt")
+		&& !is_op(op, "-le") && !is_op(op, "-gt") && !is_op(op, "-ge"))
+		return (-1);
+	if (!to_integer(a, &x))
+		return (test_error(a, "integer expression expected"));
+	if (!to_integer(b, &y))
+		return (test_error(b, "integer expression expected"));
+	if (is_op(op, "-eq"))
+		return (x != y);
+	if (is_op(op, "-ne"))
+		return (x == y);
+	if (is_op(op, "-lt"))
+		return (x >= y);
+	if (is_op(op, "-le"))
+		return (x > y);
+	if (is_op(op, "-gt"))
+		return (x <= y);
+	return (x < y);
+}
+
+static int	negate(int status)
+{
+	if (status == 2)
+		return (2);
+	return (!status);
+}
+
+static int	is_binary(const char *op)
+{
+	return (is_op(op, "=") || is_op(op, "!=") || is_op(op, "-eq")
+		|| is_op(op, "-ne") || is_op(op, "-lt") || is_op(op, "-le")
+		|| is_op(op, "-gt") || is_op(op, "-ge"));
+}
+
+static int	or_expr(t_expr *e);
+
+// ( expr ), a OP b, -X arg, or a string
+static int	primary(t_expr *e)
+{
+	char	**av;
+	int	status;
+
+	if (e->pos >= e->n)
+		return (test_error(NULL, "argument expected"));
+	av = e->av + e->pos;
+	if (e->n - e->pos >= 3 && is_binary(av[1]))
+	{
+		e->pos += 3;
+		return (binary(av[0], av[1], av[2]));
+	}
+	if (is_op(av[0], "("))
+	{
+		e->pos++;
+		status = or_expr(e);
+		if (status != 2 && (e->pos >= e->n || !is_op(e->av[e->pos], ")")))
+			return (test_error(NULL, "`)' expected"));
+		e->pos++;
+		return (status);
+	}
+	if (e->n - e->pos >= 2 && av[0][0] == '-')
+	{
+		status = unary(av[0], av[1]);
+		e->pos += 2;
+		if (status >= 0)
+			return (status);
+		e->pos -= 2;
+	}
+	e->pos++;
+	return (av[0][0] == '\0');
+}
+
+static int	not_expr(t_expr *e)
+{
+	if (e->pos + 1 < e->n && is_op(e->av[e->pos], "!"))
+	{
+		e->pos++;
+		return (negate(not_expr(e)));
+	}
+	return (primary(e));
+}
+
+static int	and_expr(t_expr *e)
+{
+	int	status;
+	int	rhs;
+
+	status = not_expr(e);
+	while (status != 2 && e->pos < e->n && is_op(e->av[e->pos], "-a"))
+	{
+		e->pos++;
+		rhs = not_expr(e);
+		if (rhs == 2)
+			return (2);
+		status = (status || rhs);
+	}
+	return (status);
+}
+
+static int	or_expr(t_expr *e)
+{
+	int	status;
+	int	rhs;
+
+	status = and_expr(e);
+	while (status != 2 && e->pos < e->n && is_op(e->av[e->pos], "-o"))
+	{
+		e->pos++;
+		rhs = and_expr(e);
+		if (rhs == 2)
+			return (2);
+		status = (status && rhs);
+	}
+	return (status);
+}
+
+// The whole of av[0..n) as one expression
+static int	expression(char **av, int n)
+{
+	t_expr	e;
+	int	status;
+
+	e.av = av;
+	e.n = n;
+	e.pos = 0;
+	status = or_expr(&e);
+	if (status != 2 && e.pos < n)
+		return (test_error(NULL, "too many arguments"));
+	return (status);
+}
+
+static int	evaluate(char **av, int n)
+{
+	int	status;
+
+	if (n == 0)
+		return (1);
+	if (n == 1)
+		return (av[0][0] == '\0');
+	if (n == 2 && is_op(av[0], "!"))
+		return (negate(evaluate(av + 1, 1)));
+	if (n == 2)
+	{
+		status = unary(av[0], av[1]);
+		if (status < 0)
+			return (test_error(av[0], "unary operator expected"));
+		return (status);
+	}
+	if (n == 3)
+	{
+		status = binary(av[0], av[1], av[2]);
+		if (status >= 0)
+			return (status);
+		if (is_op(av[0], "!"))
+			return (negate(evaluate(av + 1, 2)));
+		if (is_op(av[0], "(") && is_op(av[2], ")"))
+			return (evaluate(av + 1, 1));
+		if (is_op(av[1], "-a") || is_op(av[1], "-o"))
+			return (expression(av, n));
+		return (test_error(av[1], "binary operator expected"));
+	}
+	if (n == 4 && is_op(av[0], "!"))
+		return (negate(evaluate(av + 1, 3)));
+	if (n == 4 && is_op(av[0], "(") && is_op(av[3], ")"))
+		return (evaluate(av + 1, 2));
+	return (expression(av, n));
+}
+
+int	builtin_test(char **args)
+{
+	int	n;
+
+	n = 0;
+	while (args[n + 1])
+		n++;
+	g_name = args[0];
+	if (args[0][0] == '[')
+	{
+		if (n == 0 || !is_op(args[n], "]"))
+		{
+			fprintf(stderr, "minishell: [: missing `]'\n");
+			return (2);
+		}
+		n--;
+	}
+	return (evaluate(args + 1, n));
+}
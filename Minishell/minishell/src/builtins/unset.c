@@ -12,6 +12,7 @@
 
 
 #include "builtins.h"
+#include "executor.h"
 
 void	remove_env_var(t_env **env, char *key)
 {
@@ -26,6 +27,7 @@ void	remove_env_var(t_env **env, char *key)
 		if (ft_strncmp(current->key, key, ft_strlen(key)) == 0 &&
 		    ft_strlen(current->key) == ft_strlen(key))
 		{
+			unexport_var(current);
 			// If removing a non-head node, unlink normally
 			if (prev)
 			{
@@ -45,7 +47,10 @@ void	remove_env_var(t_env **env, char *key)
 				free(current->value);
 				current->key = next->key;
 				current->value = next->value;
+				current->exported = next->exported;
+				current->entry = next->entry;
 				current->next = next->next;
+				var_moved(next, current);
 				free(next);
 				return ;
 			}
@@ -70,6 +75,13 @@ int	builtin_unset(char **args, t_env *env)
 		return (0);
 	
 	i = 1;
+	// unset -f name...: the names are functions
+	if (ft_strncmp(args[1], "-f", 3) == 0)
+	{
+		while (args[++i])
+			unset_function(args[i]);
+		return (0);
+	}
 	while (args[i])
 	{
 		remove_env_var(&env, args[i]);
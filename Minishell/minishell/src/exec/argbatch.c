@@ -0,0 +1,217 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   argbatch.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 19:02:40 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 19:02:42 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+
+// `set -o argbatch`: when argv and the environment would not fit in
+// ARG_MAX, a command on the ARGBATCH allowlist is run once per slice of
+// its trailing arguments instead of failing with E2BIG, like xargs.
+// ARGBATCH is a colon-separated list of names; `name+N` keeps N operands
+// after the options in every batch (the mode of chmod).
+
+#define ARGBATCH_DEFAULT "rm:rmdir:touch:mkdir:chmod+1:chown+1:chgrp+1"
+#define ARGBATCH_SLACK 4096
+#define ARGBATCH_MAX_STRLEN 131072
+
+typedef struct s_batch
+{
+	char	**args;	// the command's full argv
+	char	**argv;	// argv of the batch being built
+	char	*path;
+	char	**envp;
+	int	fixed;	// leading words repeated in every batch
+	size_t	budget;	// bytes left for the trailing words of a batch
+}	t_batch;
+
+static size_t	vector_size(char **vec)
+{
+	size_t	size;
+
+	size = sizeof(char *);
+	while (*vec)
+		size += ft_strlen(*vec++) + 1 + sizeof(char *);
+	return (size);
+}
+
+// Whether execve would refuse args with envp for their size
+int	argbatch_needed(char **args, char **envp)
+{
+	long	max;
+
+	max = sysconf(_SC_ARG_MAX);
+	if (max <= 0)
+		return (0);
+	return (vector_size(args) + vector_size(envp) + ARGBATCH_SLACK
+		> (size_t)max);
+}
+
+// Operands the allowlist entry for name keeps in every batch, or -1
+// when name is not on the list
+static int	allowed_operands(const char *name, t_env *env)
+{
+	const char	*list;
+	size_t		len;
+
+	if (ft_strrchr(name, '/'))
+		name = ft_strrchr(name, '/') + 1;
+	list = get_env_value(env, "ARGBATCH");
+	if (!list)
+		list = ARGBATCH_DEFAULT;
+	len = ft_strlen(name);
+	while (*list)
+	{
+		if (ft_strncmp(list, name, len) == 0
+			&& (list[len] == ':' || list[len] == '+' || !list[len]))
+			return (list[len] == '+' ? ft_atoi(list + len + 1) : 0);
+		while (*list && *list != ':')
+			list++;
+		list += (*list == ':');
+	}
+	return (-1);
+}
+
+// Words every batch starts with: the name, its options and the fixed
+// operands. Returns -1 when the command cannot be batched.
+static int	fixed_words(char **args, t_env *env)
+{
+	int	operands;
+	int	i;
+
+	operands = allowed_operands(args[0], env);
+	if (operands < 0)
+		return (-1);
+	i = 1;
+	while (args[i] && args[i][0] == '-' && args[i][1])
+	{
+		if (ft_strncmp(args[i++], "--", 3) == 0)
+			break ;
+	}
+	while (operands-- > 0 && args[i])
+		i++;
+	if (!args[i])
+		return (-1);
+	return (i);
+}
+
+static pid_t	spawn_batch(t_batch *b)
+{
+	pid_t	pid;
+
+	pid = shell_fork();
+	if (pid != 0)
+		return (pid);
+	execve(b->path, b->argv, b->envp);
+	fprintf(stderr, "minishell: %s: %s\n", b->args[0], strerror(errno));
+	exit(errno == ENOENT ? 127 : 126);
+}
+
+// Wait for one batch; the first failure is the command's status
+static void	reap_batch(int *status, int *running)
+{
+	int	raw;
+
+	if (waitpid(-1, &raw, 0) <= 0)
+		return ;
+	(*running)--;
+	if (*status == 0)
+		*status = decode_wait_status(raw);
+}
+
+// Fill b->argv with the trailing words from args[*next] that fit
+static int	next_batch(t_batch *b, int *next)
+{
+	size_t	used;
+	size_t	cost;
+	int	n;
+
+	used = 0;
+	n = b->fixed;
+	while (b->args[*next])
+	{
+		cost = ft_strlen(b->args[*next]) + 1 + sizeof(char *);
+		if (used + cost > b->budget)
+			break ;
+		used += cost;
+		b->argv[n++] = b->args[(*next)++];
+	}
+	b->argv[n] = NULL;
+	return (n > b->fixed);
+}
+
+static int	run_batches(t_batch *b)
+{
+	int	next;
+	int	jobs;
+	int	running;
+	int	status;
+
+	jobs = get_shell()->batch_jobs;
+	if (jobs < 1)
+		jobs = 1;
+	next = b->fixed;
+	running = 0;
+	status = 0;
+	while (next_batch(b, &next))
+	{
+		if (running == jobs)
+			reap_batch(&status, &running);
+		if (spawn_batch(b) == -1)
+		{
+			perror("fork");
+			status = 1;
+			break ;
+		}
+		running++;
+	}
+	while (running > 0)
+		reap_batch(&status, &running);
+	return (status);
+}
+
+// Run path over batches of args, each small enough for execve, and
+// return the exit status. Returns -1 (nothing run) when the command is
+// not allowlisted or one word alone is too big to pass.
+int	argbatch_run(char *path, char **args, char **envp, t_env *env)
+{
+	t_batch	b;
+	size_t	base;
+	size_t	words;
+	int	status;
+
+	b.fixed = fixed_words(args, env);
+	if (b.fixed < 0)
+		return (-1);
+	b.args = args;
+	b.path = path;
+	b.envp = envp;
+	base = vector_size(envp) + ARGBATCH_SLACK + sizeof(char *);
+	words = 0;
+	while (words < (size_t)b.fixed)
+		base += ft_strlen(args[words++]) + 1 + sizeof(char *);
+	if (base >= (size_t)sysconf(_SC_ARG_MAX))
+		return (-1);
+	b.budget = (size_t)sysconf(_SC_ARG_MAX) - base;
+	while (args[words])
+	{
+		if (ft_strlen(args[words]) >= ARGBATCH_MAX_STRLEN
+			|| ft_strlen(args[words]) + 1 + sizeof(char *) > b.budget)
+			return (-1);
+		words++;
+	}
+	b.argv = malloc(sizeof(char *) * (words + 1));
+	if (!b.argv)
+		return (-1);
+	ft_memcpy(b.argv, args, sizeof(char *) * b.fixed);
+	status = run_batches(&b);
+	free(b.argv);
+	return (status);
+}
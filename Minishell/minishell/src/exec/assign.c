@@ -0,0 +1,176 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   assign.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:10:52 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:10:55 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+#include "expander.h"
+
+// NAME=value words. On a line of their own they set shell variables;
+// before a program they only change that program's envp (envp.c);
+// before a builtin or a function they hold for the call and are undone
+// after it.
+
+// *env is the real head of the list: the first variable of an empty
+// environment is linked there
+static void	assign_one(const char *word, t_env **env, int exported)
+{
+	t_env	*var;
+	char	*name;
+
+	name = ft_substr(word, 0, ft_strchr(word, '=') - word);
+	if (!name)
+		return ;
+	set_env_value(env, name, ft_strchr(word, '=') + 1);
+	var = find_env(*env, name);
+	if (var && exported)
+		export_var(var);
+	free(name);
+}
+
+// Set already expanded NAME=value words as shell variables
+void	assign_words(char **words, t_env *env)
+{
+	while (*words)
+		assign_one(*words++, &env, 0);
+}
+
+// NAME=value with the value expanded, as a new string
+static char	*expand_assign(const char *word, t_env *env, int status)
+{
+	char	*value;
+	char	*name;
+	char	*out;
+
+	value = expand_word(ft_strchr(word, '=') + 1, env, status);
+	name = ft_substr(word, 0, ft_strchr(word, '=') - word + 1);
+	out = NULL;
+	if (value && name)
+		out = ft_strjoin(name, value);
+	free(value);
+	free(name);
+	return (out);
+}
+
+// The words of assigns with their values expanded, as a new array.
+// Left to right, as for a line of assignments: a value that expands
+// something sees the ones before it, set for the time it is expanded,
+// so `a=1 b=$a cmd` passes b=1.
+char	**expand_assigns(char **assigns, t_env *env)
+{
+	char	**out;
+	t_env	*saved;
+	int	status;
+	int	n;
+
+	status = get_shell()->last_status;
+	n = 0;
+	while (assigns[n])
+		n++;
+	out = ft_calloc(n + 1, sizeof(char *));
+	n = 0;
+	while (out && assigns[n])
+	{
+		saved = NULL;
+		if (n > 0 && ft_strchr(assigns[n], '$'))
+			saved = push_assigns(out, env);
+		out[n] = expand_assign(assigns[n], env, status);
+		pop_assigns(saved, env);
+		if (!out[n++])
+		{
+			free_env_array(out);
+			return (NULL);
+		}
+	}
+	return (out);
+}
+
+// NAME=value NAME=value...: each value is expanded after the ones
+// before it are set, so `a=1 b=$a` works. The status is that of the
+// last $(...) in the values, 0 when there is none.
+int	assign_variables(char **assigns, t_env *env)
+{
+	char	*word;
+	int	status;
+	int	substs;
+
+	status = get_shell()->last_status;
+	substs = get_shell()->subst_count;
+	while (*assigns)
+	{
+		word = expand_assign(*assigns, env, status);
+		if (!word)
+			return (1);
+		assign_one(word, &env, 0);
+		free(word);
+		assigns++;
+	}
+	if (get_shell()->subst_count != substs)
+		return (get_shell()->last_status);
+	return (0);
+}
+
+// Set the already expanded assigns for one call, exported as a program
+// would see them. Returns the variables as they were, for restore.
+t_env	*push_assigns(char **assigns, t_env *env)
+{
+	t_env	*saved;
+	t_env	*node;
+	t_env	*var;
+
+	saved = NULL;
+	while (*assigns)
+	{
+		node = ft_calloc(1, sizeof(t_env));
+		if (!node)
+			break ;
+		node->key = ft_substr(*assigns, 0,
+				ft_strchr(*assigns, '=') - *assigns);
+		var = NULL;
+		if (node->key)
+			var = find_env(env, node->key);
+		if (var)
+		{
+			node->value = ft_strdup(var->value);
+			node->exported = var->exported;
+		}
+		node->next = saved;
+		saved = node;
+		assign_one(*assigns++, &env, 1);
+	}
+	return (saved);
+}
+
+// Put back what push_assigns changed, last assignment first
+void	pop_assigns(t_env *saved, t_env *env)
+{
+	t_env	*next;
+	t_env	*var;
+
+	while (saved)
+	{
+		next = saved->next;
+		if (saved->key && !saved->value)
+			remove_env_var(&env, saved->key);
+		else if (saved->key)
+		{
+			set_env_value(&env, saved->key, saved->value);
+			var = find_env(env, saved->key);
+			if (var && saved->exported)
+				export_var(var);
+			else if (var)
+				unexport_var(var);
+		}
+		free(saved->key);
+		free(saved->value);
+		free(saved);
+		saved = next;
+	}
+}
@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   envp.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:02:37 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:02:39 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+
+// Argument vectors, and the envp of a program with assignments laid
+// over the exported environment (get_envp)
+
+void	free_env_array(char **env_array)
+{
+	int	i;
+
+	if (!env_array)
+		return ;
+	i = 0;
+	while (env_array[i])
+	{
+		free(env_array[i]);
+		i++;
+	}
+	free(env_array);
+}
+
+// Index of the NAME=... entry of envp for the name of assign, or -1
+static int	find_entry(char **envp, const char *assign)
+{
+	size_t	len;
+	int	i;
+
+	len = ft_strchr(assign, '=') - assign + 1;
+	i = 0;
+	while (envp[i] && ft_strncmp(envp[i], assign, len) != 0)
+		i++;
+	if (!envp[i])
+		return (-1);
+	return (i);
+}
+
+// envp with each NAME=value of assigns in place of the entry for NAME,
+// or after the others when there is none. Only the array is new: the
+// strings are those of envp and assigns, so free just the array.
+char	**envp_overlay(char **envp, char **assigns)
+{
+	char	**overlay;
+	int	count;
+	int	added;
+	int	at;
+
+	count = 0;
+	while (envp[count])
+		count++;
+	added = 0;
+	while (assigns[added])
+		added++;
+	overlay = malloc(sizeof(char *) * (count + added + 1));
+	if (!overlay)
+		return (NULL);
+	ft_memcpy(overlay, envp, sizeof(char *) * (count + 1));
+	while (*assigns)
+	{
+		at = find_entry(overlay, *assigns);
+		if (at < 0)
+		{
+			at = count++;
+			overlay[count] = NULL;
+		}
+		overlay[at] = *assigns++;
+	}
+	return (overlay);
+}
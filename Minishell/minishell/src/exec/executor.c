@@ -12,9 +12,13 @@
 
 #include "executor.h"
 #include "builtins.h"
+#include "expander.h"
 #include "signals.h"
+#include "vm.h"
+#include "history.h"
 #include <fcntl.h>
 #include <signal.h>
+#include <limits.h>
 
 static void	print_minishell_error(const char *name, const char *msg)
 {
@@ -23,6 +27,24 @@ static void	print_minishell_error(const char *name, const char *msg)
     fprintf(stderr, "minishell: %s: %s\n", name, msg);
 }
 
+// Flush stdio before forking so buffered builtin output is not
+// written a second time when the child exits. The envp of programs is
+// brought up to date first, so that children inherit it ready.
+pid_t	shell_fork(void)
+{
+	pid_t	pid;
+
+	fflush(stdout);
+	fflush(stderr);
+	get_envp(); // built once here rather than in every child
+	input_sync();
+
+	pid = fork();
+	if (pid == 0)
+		get_shell()->interactive = 0; // subshells do not talk to the user
+	return (pid);
+}
+
 static int	precheck_and_map_path(const char *path, int *mapped_exit, const char **msg)
 {
     struct stat st;
@@ -84,63 +106,9 @@ static int	map_exec_errno(const char *cmd, int had_slash, int err, const char **
     return (126);
 }
 
-static char	**env_to_array(t_env *env)
-{
-	t_env	*current;
-	char	**env_array;
-	char	*temp;
-	int	count;
-	int	i;
-
-	count = 0;
-	current = env;
-	while (current)
-	{
-		count++;
-		current = current->next;
-	}
-	
-	env_array = malloc(sizeof(char *) * (count + 1));
-	if (!env_array)
-		return (NULL);
-	
-	current = env;
-	i = 0;
-	while (current)
-	{
-		temp = ft_strjoin(current->key, "=");
-		if (temp)
-		{
-			env_array[i] = ft_strjoin(temp, current->value);
-			free(temp);
-		}
-		else
-			env_array[i] = NULL;
-		current = current->next;
-		i++;
-	}
-	env_array[i] = NULL;
-	return (env_array);
-}
-
-static void	free_env_array(char **env_array)
-{
-	int	i;
-
-	if (!env_array)
-		return ;
-	i = 0;
-	while (env_array[i])
-	{
-		free(env_array[i]);
-		i++;
-	}
-	free(env_array);
-}
-
-static int	search_path_for_cmd(char *cmd, t_env *env, char **out_path)
+static int	search_path_for_cmd(char *cmd, const char *path_env,
+		char **out_path)
 {
-    char	*path_env;
     char	**paths;
     int		i;
     int		seen_eacces;
@@ -148,7 +116,6 @@ static int	search_path_for_cmd(char *cmd, t_env *env, char **out_path)
     if (out_path)
         *out_path = NULL;
 
-    path_env = get_env_value(env, "PATH");
     if (!path_env || path_env[0] == '\0')
         return (127); // PATH unset/empty => command not found
 
@@ -203,155 +170,144 @@ static int	search_path_for_cmd(char *cmd, t_env *env, char **out_path)
     return (seen_eacces ? 126 : 127);
 }
 
-static int	handle_redirections(t_redir *redirs)
+// Copy a redirection list with every target expanded. Heredoc
+// delimiters only lose their quotes.
+static t_redir	*expand_redirs(t_redir *redirs, t_env *env)
 {
-	int	fd;
+	t_redir	*head;
+	t_redir	**tail;
+	t_redir	*node;
 
+	head = NULL;
+	tail = &head;
 	while (redirs)
 	{
-		if (redirs->type == REDIR_IN)
-		{
-			fd = open(redirs->file, O_RDONLY);
-			if (fd == -1)
-			{
-				perror(redirs->file);
-				return (1);
-			}
-			if (dup2(fd, STDIN_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
-			close(fd);
-		}
-		else if (redirs->type == REDIR_OUT)
+		node = malloc(sizeof(t_redir));
+		if (!node)
+			break ;
+		node->type = redirs->type;
+		node->fd = redirs->fd;
+		node->body = NULL;
+		node->next = NULL;
+		if (redirs->type == REDIR_HEREDOC)
+			node->file = remove_quotes(redirs->file);
+		else
+			node->file = expand_word(redirs->file, env,
+					get_shell()->last_status);
+		if (node->file && node->file[0] == '\0'
+			&& redirs->type != REDIR_HEREDOC
+			&& !ft_strchr(redirs->file, '\'') && !ft_strchr(redirs->file, '"'))
 		{
-			fd = open(redirs->file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-			if (fd == -1)
-			{
-				perror(redirs->file);
-				return (1);
-			}
-			if (dup2(fd, STDOUT_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
-			close(fd);
+			print_minishell_error(redirs->file, "ambiguous redirect");
+			free(node->file);
+			node->file = NULL;
 		}
-		else if (redirs->type == REDIR_APPEND)
+		if (node->file && redirs->body)
+			node->body = ft_strdup(redirs->body);
+		if (!node->file || (redirs->body && !node->body))
 		{
-			fd = open(redirs->file, O_WRONLY | O_CREAT | O_APPEND, 0644);
-			if (fd == -1)
-			{
-				perror(redirs->file);
-				return (1);
-			}
-			if (dup2(fd, STDOUT_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
-			close(fd);
+			free(node->file);
+			free(node);
+			free_redirs(head);
+			return (NULL);
 		}
-		else if (redirs->type == REDIR_HEREDOC)
+		*tail = node;
+		tail = &node->next;
+		redirs = redirs->next;
+	}
+	return (head);
+}
+
+// `> file` with no command: open (and truncate) the targets, run nothing
+static int	redirect_only(t_redir *redirs)
+{
+	t_redir_state	state;
+	int		status;
+
+	if (!redirs)
+		return (0);
+	status = apply_redirections(redirs, &state);
+	restore_redirections(&state);
+	return (status);
+}
+
+// Unlinked temporary file holding len bytes of body, rewound
+static int	heredoc_file(const char *body, size_t len)
+{
+	char	path[] = "/tmp/minishell-heredoc-XXXXXX";
+	ssize_t	n;
+	int	fd;
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		return (-1);
+	unlink(path);
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	while (len > 0)
+	{
+		n = write(fd, body, len);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (n < 0)
 		{
-			// Heredoc should be handled in parser/pre-processing
-			// For now, create a temporary file
-			fd = handle_heredoc(redirs->file);
-			if (fd == -1)
-				return (1);
-			if (dup2(fd, STDIN_FILENO) == -1)
-			{
-				perror("dup2");
-				close(fd);
-				return (1);
-			}
 			close(fd);
+			return (-1);
 		}
-		redirs = redirs->next;
+		body += n;
+		len -= n;
 	}
-	return (0);
+	lseek(fd, 0, SEEK_SET);
+	return (fd);
 }
 
-int	handle_heredoc(char *delimiter)
+// An fd reading the heredoc body collected by the parser. A small body
+// goes through a pipe, which takes it whole without a reader; a bigger
+// one through a temporary file, since nothing would drain the pipe.
+int	handle_heredoc(const char *body)
 {
 	int	pipefd[2];
-	char	*line;
-	pid_t	pid;
-
-	if (pipe(pipefd) == -1)
+	size_t	len;
+
+	if (!body)
+		body = "";
+	len = ft_strlen(body);
+	if (len > PIPE_BUF)
+		return (heredoc_file(body, len));
+	if (shell_pipe(pipefd) == -1)
 	{
 		perror("pipe");
 		return (-1);
 	}
+	write(pipefd[1], body, len);
+	close(pipefd[1]);
+	return (pipefd[0]);
+}
 
-	pid = fork();
-	if (pid == -1)
-	{
-		perror("fork");
-		close(pipefd[0]);
-		close(pipefd[1]);
-		return (-1);
-	}
+// Value of the last PATH=value of assigns, or NULL
+static const char	*assigned_path(char **assigns)
+{
+	const char	*path;
 
-	if (pid == 0)
-	{
-		// Child process - read heredoc content
-		/* Reset signals so heredoc child exits on Ctrl-C and behaves like a normal process */
-		signal(SIGINT, SIG_DFL);
-		signal(SIGQUIT, SIG_DFL);
-		close(pipefd[0]);
-		while (1)
-		{
-			line = readline("> ");
-			if (!line || (ft_strlen(line) == ft_strlen(delimiter) && 
-			ft_strncmp(line, delimiter, ft_strlen(delimiter)) == 0))
-			{
-				free(line);
-				break ;
-			}
-			write(pipefd[1], line, ft_strlen(line));
-			write(pipefd[1], "\n", 1);
-			free(line);
-		}
-		close(pipefd[1]);
-		exit(0);
-	}
-	else
+	path = NULL;
+	while (assigns && *assigns)
 	{
-		// Parent process - ignore SIGINT while waiting for heredoc child
-		close(pipefd[1]);
-		signal(SIGINT, SIG_IGN);
-		signal(SIGQUIT, SIG_IGN);
-		waitpid(pid, NULL, 0);
-		// Restore parent handlers
-		signal(SIGINT, handle_sigint);
-		signal(SIGQUIT, SIG_IGN);
-		return (pipefd[0]);
+		if (ft_strncmp(*assigns, "PATH=", 5) == 0)
+			path = *assigns + 5;
+		assigns++;
 	}
+	return (path);
 }
 
-static int	execute_simple_command(t_simple_cmd *cmd, t_env *env)
+// Find the program to run for cmd->args[0]. Returns 0 and sets
+// *executable, or prints the error and returns the exit status. A
+// `PATH=dirs cmd` is looked for in dirs, without the PATH cache.
+static int	resolve_command(t_simple_cmd *cmd, t_env *env, char **executable)
 {
-    char	*executable;
-    char	**env_array;
-    pid_t	pid;
-    int	status;
     int	mapped_exit;
     const char *msg;
+    const char *path;
 
-    if (!cmd->args || !cmd->args[0] || cmd->args[0][0] == '\0')
-        return (0);
-    
-    // Handle built-in commands (don't fork for built-ins)
-    if (is_builtin(cmd->args[0]))
-        return (execute_builtin(cmd, env));
-
-    executable = NULL;
+    *executable = NULL;
 
     // When the command contains '/', treat as a path
     if (ft_strchr(cmd->args[0], '/'))
@@ -363,181 +319,448 @@ static int	execute_simple_command(t_simple_cmd *cmd, t_env *env)
             return (mapped_exit);
         }
         // Use the given path directly
-        executable = cmd->args[0];
+        *executable = cmd->args[0];
+        return (0);
     }
-    else
+    path = assigned_path(cmd->assigns);
+    if (!path)
     {
-        int res = search_path_for_cmd(cmd->args[0], env, &executable);
-        if (res == 126)
-        {
-            print_minishell_error(cmd->args[0], "Permission denied");
-            return (126);
-        }
-        if (res == 127)
-        {
-            print_minishell_error(cmd->args[0], "command not found");
-            return (127);
-        }
-        // res == 0 => executable set (allocated)
-    }
-    
-    env_array = env_to_array(env);
-    
-	pid = fork();
-	if (pid == 0)
-	{
-		/* Child process - restore default signal handling so it
-		   reacts normally to SIGINT/SIGQUIT (like /bin/cat) */
-		signal(SIGINT, SIG_DFL);
-		signal(SIGQUIT, SIG_DFL);
-
-		/* Child process - handle redirections here */
-		if (handle_redirections(cmd->redirs) != 0)
-			exit(1);
-
-		execve(executable, cmd->args, env_array);
-        // On execve failure, map errno to message/exit code
-        msg = NULL;
-        mapped_exit = map_exec_errno(cmd->args[0], ft_strchr(cmd->args[0], '/') != NULL, errno, &msg);
-        print_minishell_error(cmd->args[0], msg);
-        exit(mapped_exit);
+        *executable = path_lookup(cmd->args[0], env);
+        if (*executable)
+            return (0);
+        path = get_env_value(env, "PATH");
     }
-    else if (pid > 0)
+    int res = search_path_for_cmd(cmd->args[0], path, executable);
+    if (res == 126)
     {
-		// Parent process - ignore SIGINT/SIGQUIT while waiting for child
-		signal(SIGINT, SIG_IGN);
-		signal(SIGQUIT, SIG_IGN);
-		waitpid(pid, &status, 0);
-		// Restore parent signal handlers: keep SIGQUIT ignored and
-		// SIGINT handled by readline handler
-		signal(SIGINT, handle_sigint);
-		signal(SIGQUIT, SIG_IGN);
-        // Free only if it was allocated (PATH search)
-        if (executable != cmd->args[0])
-            free(executable);
-        free_env_array(env_array);
-        if (WIFEXITED(status))
-            return (WEXITSTATUS(status));
-		/* If child terminated by signal, return 128 + signum (common bash behaviour) */
-		if (WIFSIGNALED(status))
-			return (128 + WTERMSIG(status));
-		return (1);
+        print_minishell_error(cmd->args[0], "Permission denied");
+        return (126);
     }
-    else
+    if (res == 127)
     {
-        perror("fork");
-        if (executable && executable != cmd->args[0])
-            free(executable);
-        free_env_array(env_array);
-        return (1);
+        print_minishell_error(cmd->args[0], "command not found");
+        return (127);
     }
+    // res == 0 => executable set (allocated)
+    return (0);
 }
 
-static int	execute_pipe_command(t_command *cmd, t_env *env)
+// Child side of an external command: never returns.
+static void	exec_external(t_simple_cmd *cmd, char *executable, t_env *env)
 {
-	int	pipefd[2];
-	pid_t	pid1;
-	pid_t	pid2;
-	int	status1;
-	int	status2;
-	int	final_status;
-
-	if (pipe(pipefd) == -1)
+	char		**env_array;
+	int		mapped_exit;
+	const char	*msg;
+
+	/* Restore default signal handling so the program
+	   reacts normally to SIGINT/SIGQUIT (like /bin/cat) */
+	signal(SIGINT, SIG_DFL);
+	signal(SIGQUIT, SIG_DFL);
+
+	cloexec_inherited_fds();
+	keep_process_substitutions_open();
+	if (apply_redirections(cmd->redirs, NULL) != 0)
+		exit(1);
+
+	env_array = get_envp();
+	if (env_array && cmd->assigns)
+		env_array = envp_overlay(env_array, cmd->assigns);
+	trace_inherited_fds(cmd->args[0]);
+	if ((get_shell()->options & OPT_ARGBATCH) && env_array
+		&& argbatch_needed(cmd->args, env_array))
 	{
-		perror("pipe");
-		return (1);
+		mapped_exit = argbatch_run(executable, cmd->args, env_array, env);
+		if (mapped_exit >= 0)
+			exit(mapped_exit);
 	}
+	execve(executable, cmd->args, env_array);
+	// On execve failure, map errno to message/exit code
+	msg = NULL;
+	mapped_exit = map_exec_errno(cmd->args[0], ft_strchr(cmd->args[0], '/') != NULL, errno, &msg);
+	print_minishell_error(cmd->args[0], msg);
+	exit(mapped_exit);
+}
+
+int	decode_wait_status(int status)
+{
+	if (WIFEXITED(status))
+		return (WEXITSTATUS(status));
+	/* If child terminated by signal, return 128 + signum (common bash behaviour) */
+	if (WIFSIGNALED(status))
+		return (128 + WTERMSIG(status));
+	return (1);
+}
+
+// A builtin or a function, with the assignments written before it in
+// force for the call only
+static int	run_in_shell(t_simple_cmd *cmd, int builtin, t_env *env)
+{
+	t_env	*saved;
+	int	status;
+
+	saved = NULL;
+	if (cmd->assigns)
+		saved = push_assigns(cmd->assigns, env);
+	if (find_function(cmd->args[0]))
+		status = call_function(find_function(cmd->args[0]), cmd, env);
+	else
+		status = run_builtin(builtin, cmd, env);
+	pop_assigns(saved, env);
+	return (status);
+}
+
+// Fork and exec the program cmd names, and wait for it
+static int	run_external(t_simple_cmd *cmd, t_env *env)
+{
+	char	*executable;
+	pid_t	pid;
+	int	status;
 
-	pid1 = fork();
-	if (pid1 == -1)
+	status = resolve_command(cmd, env, &executable);
+	if (status != 0)
+		return (status);
+	
+	pid = shell_fork();
+	if (pid == 0)
+		exec_external(cmd, executable, env);
+	// Free only if it was allocated (PATH search)
+	if (executable != cmd->args[0])
+		free(executable);
+	if (pid == -1)
 	{
 		perror("fork");
-		close(pipefd[0]);
-		close(pipefd[1]);
 		return (1);
 	}
+	// Parent process - ignore SIGINT/SIGQUIT while waiting for child
+	signal(SIGINT, SIG_IGN);
+	signal(SIGQUIT, SIG_IGN);
+	waitpid(pid, &status, 0);
+	// Restore parent signal handlers: keep SIGQUIT ignored and
+	// SIGINT handled by readline handler
+	signal(SIGINT, handle_sigint);
+	signal(SIGQUIT, SIG_IGN);
+	return (decode_wait_status(status));
+}
 
-	if (pid1 == 0)
+static int	run_simple_command(t_simple_cmd *cmd, t_env *env)
+{
+	int	status;
+
+	if (!cmd->args || !cmd->args[0])
 	{
-		/* First child process (left side of pipe) */
-		/* Reset signals to defaults in child */
-		signal(SIGINT, SIG_DFL);
-		signal(SIGQUIT, SIG_DFL);
+		// `A=1 > file`, or a command name that expanded to nothing
+		status = redirect_only(cmd->redirs);
+		if (status == 0 && cmd->assigns)
+			assign_words(cmd->assigns, env);
+		return (status);
+	}
+	if (cmd->args[0][0] == '\0')
+		return (0);
+	// Handle functions and built-in commands (don't fork for them)
+	if (find_function(cmd->args[0]) || is_builtin(cmd->args[0]))
+		return (run_in_shell(cmd, builtin_id(cmd->args[0]), env));
+	return (run_external(cmd, env));
+}
 
-		close(pipefd[0]); // Close read end
-		if (dup2(pipefd[1], STDOUT_FILENO) == -1)
-		{
-			perror("dup2");
-			exit(1);
-		}
-		close(pipefd[1]); // Close write end after dup2
-		exit(execute_command(cmd->data.pipe_cmd.left, env));
+// `env NAME=value... cmd args...`: cmd is always a program
+int	execute_env_command(char **args, char **assigns, t_env *env)
+{
+	t_simple_cmd	cmd;
+
+	cmd.args = args;
+	cmd.redirs = NULL;
+	cmd.assigns = assigns;
+	return (run_external(&cmd, env));
+}
+
+// Expand argv and redirection targets into *out. Returns 0 on success.
+static int	expand_simple_cmd(t_simple_cmd *cmd, t_env *env, t_simple_cmd *out)
+{
+	out->args = expand_args(cmd->args, env, get_shell()->last_status);
+	if (!out->args)
+		return (1);
+	out->redirs = NULL;
+	out->assigns = NULL;
+	if (cmd->assigns)
+		out->assigns = expand_assigns(cmd->assigns, env);
+	if (cmd->redirs && (!cmd->assigns || out->assigns))
+		out->redirs = expand_redirs(cmd->redirs, env);
+	if ((cmd->assigns && !out->assigns) || (cmd->redirs && !out->redirs))
+	{
+		free_env_array(out->args);
+		free_env_array(out->assigns);
+		return (1);
 	}
+	return (0);
+}
+
+static void	free_expanded_cmd(t_simple_cmd *cmd)
+{
+	free_env_array(cmd->args);
+	free_env_array(cmd->assigns);
+	free_redirs(cmd->redirs);
+}
+
+static int	execute_simple_command(t_simple_cmd *cmd, t_env *env)
+{
+	t_simple_cmd	expanded;
+	int		status;
+	int		substs;
+
+	if (!cmd->args && cmd->assigns && !cmd->redirs)
+		return (assign_variables(cmd->assigns, env));
+	substs = get_shell()->subst_count;
+	if (expand_simple_cmd(cmd, env, &expanded) != 0)
+		return (1);
+	status = run_simple_command(&expanded, env);
+	// `$(false)` expanding to no command has the substitution's status
+	if (!expanded.args[0] && status == 0 && get_shell()->subst_count != substs)
+		status = get_shell()->last_status;
+	free_expanded_cmd(&expanded);
+	return (status);
+}
+
+// A simple command whose name was resolved to builtin when it was
+// compiled. A function defined since under that name still wins.
+int	execute_builtin_command(t_simple_cmd *cmd, int builtin, t_env *env)
+{
+	t_simple_cmd	expanded;
+	int		status;
+	int		mark;
 
-	pid2 = fork();
-	if (pid2 == -1)
+	mark = get_shell()->procsub_count;
+	status = 1;
+	if (expand_simple_cmd(cmd, env, &expanded) == 0)
 	{
-		perror("fork");
-		close(pipefd[0]);
-		close(pipefd[1]);
+		if (!expanded.args[0])
+			status = run_simple_command(&expanded, env);
+		else
+			status = run_in_shell(&expanded, builtin, env);
+		free_expanded_cmd(&expanded);
+	}
+	reap_process_substitutions(mark);
+	get_shell()->last_status = status;
+	return (status);
+}
+
+// A simple command that is a whole pipeline stage: the stage's child
+// becomes the program itself instead of forking once more.
+static int	execute_simple_stage(t_simple_cmd *cmd, t_env *env)
+{
+	t_simple_cmd	expanded;
+	char		*executable;
+	int		status;
+
+	if (expand_simple_cmd(cmd, env, &expanded) != 0)
 		return (1);
+	if (!expanded.args[0] || expanded.args[0][0] == '\0'
+		|| is_builtin(expanded.args[0]) || find_function(expanded.args[0]))
+		status = run_simple_command(&expanded, env);
+	else
+	{
+		status = resolve_command(&expanded, env, &executable);
+		if (status == 0)
+			exec_external(&expanded, executable, env);
 	}
+	free_expanded_cmd(&expanded);
+	return (status);
+}
+
+// Builtins whose effect must not leak out of a ( ... ) group
+static int	is_state_builtin(char *word)
+{
+	char	*name;
+	int	result;
 
-	if (pid2 == 0)
+	if (ft_strchr(word, '$'))
+		return (1); // Command name only known after expansion
+	name = remove_quotes(word);
+	if (!name)
+		return (1);
+	result = (find_function(name) || ft_strncmp(name, "cd", 3) == 0
+			|| ft_strncmp(name, "set", 4) == 0
+			|| ft_strncmp(name, "export", 7) == 0
+			|| ft_strncmp(name, "unset", 6) == 0
+			|| ft_strncmp(name, "alias", 6) == 0
+			|| ft_strncmp(name, "unalias", 8) == 0
+			|| ft_strncmp(name, "pushd", 6) == 0
+			|| ft_strncmp(name, "popd", 5) == 0
+			|| ft_strncmp(name, "dirs", 5) == 0
+			|| ft_strncmp(name, "history", 8) == 0
+			|| ft_strncmp(name, "exit", 5) == 0);
+	free(name);
+	return (result);
+}
+
+// Whether expanding a redirection target can assign a variable
+static int	redirs_assign(t_redir *redirs)
+{
+	while (redirs)
 	{
-		/* Second child process (right side of pipe) */
-		/* Reset signals to defaults in child */
-		signal(SIGINT, SIG_DFL);
-		signal(SIGQUIT, SIG_DFL);
+		if (redirs->type != REDIR_HEREDOC && word_assigns(redirs->file))
+			return (1);
+		redirs = redirs->next;
+	}
+	return (0);
+}
 
-		close(pipefd[1]); // Close write end
-		if (dup2(pipefd[0], STDIN_FILENO) == -1)
-		{
-			perror("dup2");
-			exit(1);
-		}
-		close(pipefd[0]); // Close read end after dup2
-		exit(execute_command(cmd->data.pipe_cmd.right, env));
+// Whether running cmd in the shell process could change shell state:
+// a builtin that does, or a word whose expansion assigns. Pipeline
+// stages run in children (except the last one under lastpipe), and
+// nested groups decide for themselves.
+static int	changes_shell_state(t_command *cmd)
+{
+	if (!cmd)
+		return (0);
+	if (cmd->type == CMD_PIPE)
+	{
+		if (!(get_shell()->options & OPT_LASTPIPE))
+			return (0);
+		while (cmd->type == CMD_PIPE)
+			cmd = cmd->data.pipe_cmd.right;
+		return (changes_shell_state(cmd));
 	}
+	if (cmd->type == CMD_SIMPLE)
+		return ((!cmd->data.simple.args && cmd->data.simple.assigns)
+			|| (cmd->data.simple.args
+				&& is_state_builtin(cmd->data.simple.args[0]))
+			|| words_assign(cmd->data.simple.args)
+			|| words_assign(cmd->data.simple.assigns)
+			|| redirs_assign(cmd->data.simple.redirs));
+	if (cmd->type == CMD_LIST)
+		return (changes_shell_state(cmd->data.list.left)
+			|| changes_shell_state(cmd->data.list.right));
+	if (cmd->type == CMD_GROUP)
+		return (changes_shell_state(cmd->data.subshell.body)
+			|| redirs_assign(cmd->data.subshell.redirs));
+	return (cmd->type == CMD_FUNCDEF || cmd->type == CMD_COMPOUND);
+}
 
-	// Parent process - close both ends of pipe
-	close(pipefd[0]);
-	close(pipefd[1]);
+// Run the body of a group in the current process with the group's
+// redirections applied around it.
+static int	run_subshell_in_place(t_command *cmd, t_env *env)
+{
+	t_redir		*redirs;
+	t_redir_state	state;
+	int		status;
+
+	if (!cmd->data.subshell.redirs)
+		return (execute_command(cmd->data.subshell.body, env));
+	redirs = expand_redirs(cmd->data.subshell.redirs, env);
+	if (!redirs)
+		return (1);
+	status = apply_redirections(redirs, &state);
+	if (status == 0)
+		status = execute_command(cmd->data.subshell.body, env);
+	restore_redirections(&state);
+	free_redirs(redirs);
+	return (status);
+}
 
-	// Parent should ignore SIGINT/SIGQUIT while waiting for pipeline children
-	signal(SIGINT, SIG_IGN);
-	signal(SIGQUIT, SIG_IGN);
+// `return` inside ( ... ) only leaves the subshell
+static int	run_subshell_body(t_command *cmd, t_env *env)
+{
+	int	status;
 
-	// Wait for both children
-	waitpid(pid1, &status1, 0);
-	waitpid(pid2, &status2, 0);
+	status = run_subshell_in_place(cmd, env);
+	if (cmd->type == CMD_SUBSHELL)
+		get_shell()->returning = 0;
+	return (status);
+}
+
+// A group only needs its own process when it could change shell state;
+// `( cmd1; cmd2 ) > log` runs without forking.
+static int	execute_subshell(t_command *cmd, t_env *env)
+{
+	pid_t	pid;
+	int	status;
 
-	// Restore parent handlers
+	if (!changes_shell_state(cmd->data.subshell.body)
+		&& !redirs_assign(cmd->data.subshell.redirs))
+		return (run_subshell_body(cmd, env));
+	pid = shell_fork();
+	if (pid == -1)
+	{
+		perror("fork");
+		return (1);
+	}
+	if (pid == 0)
+	{
+		signal(SIGINT, SIG_DFL);
+		signal(SIGQUIT, SIG_DFL);
+		exit(run_subshell_in_place(cmd, env));
+	}
+	signal(SIGINT, SIG_IGN);
+	signal(SIGQUIT, SIG_IGN);
+	waitpid(pid, &status, 0);
 	signal(SIGINT, handle_sigint);
 	signal(SIGQUIT, SIG_IGN);
+	return (decode_wait_status(status));
+}
 
-	// Return exit status of the last command in the pipeline
-	if (WIFEXITED(status2))
-		final_status = WEXITSTATUS(status2);
-	else if (WIFSIGNALED(status2))
-		final_status = 128 + WTERMSIG(status2);
-	else
-		final_status = 1;
+// if/while/for/case: run the compiled program with the redirections
+// after `fi`, `done` or `esac` applied around the whole of it
+static int	execute_compound(t_command *cmd, t_env *env)
+{
+	t_redir		*redirs;
+	t_redir_state	state;
+	int		status;
+
+	if (!cmd->data.compound.redirs)
+		return (vm_run(cmd->data.compound.prog, env));
+	redirs = expand_redirs(cmd->data.compound.redirs, env);
+	if (!redirs)
+		return (1);
+	status = apply_redirections(redirs, &state);
+	if (status == 0)
+		status = vm_run(cmd->data.compound.prog, env);
+	restore_redirections(&state);
+	free_redirs(redirs);
+	return (status);
+}
 
-	return (final_status);
+// Run one pipeline stage inside the child that was forked for it. The
+// stage already has a process of its own, so neither a group nor an
+// external command needs a second fork.
+int	execute_stage(t_command *cmd, t_env *env)
+{
+	if (cmd && (cmd->type == CMD_SUBSHELL || cmd->type == CMD_GROUP))
+		return (run_subshell_in_place(cmd, env));
+	if (cmd && cmd->type == CMD_SIMPLE)
+		return (execute_simple_stage(&cmd->data.simple, env));
+	return (execute_command(cmd, env));
 }
 
 int	execute_command(t_command *cmd, t_env *env)
 {
+	int	status;
+	int	mark;
+
 	if (!cmd)
 		return (0);
 	
+	mark = get_shell()->procsub_count;
+	status = 0;
 	if (cmd->type == CMD_SIMPLE)
-		return (execute_simple_command(&cmd->data.simple, env));
+		status = execute_simple_command(&cmd->data.simple, env);
 	else if (cmd->type == CMD_PIPE)
+		status = execute_pipe_command(cmd, env);
+	else if (cmd->type == CMD_SUBSHELL)
+		status = execute_subshell(cmd, env);
+	else if (cmd->type == CMD_GROUP)
+		status = run_subshell_in_place(cmd, env);
+	else if (cmd->type == CMD_COMPOUND)
+		status = execute_compound(cmd, env);
+	else if (cmd->type == CMD_FUNCDEF)
+		status = define_function(cmd->data.funcdef.name,
+				cmd->data.funcdef.body);
+	else if (cmd->type == CMD_LIST)
 	{
-		return (execute_pipe_command(cmd, env));
+		status = execute_command(cmd->data.list.left, env);
+		if (!get_shell()->returning)
+			status = execute_command(cmd->data.list.right, env);
 	}
-	
-	return (0);
+	reap_process_substitutions(mark);
+	get_shell()->last_status = status;
+	return (status);
 }
@@ -0,0 +1,253 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fanout.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:10:45 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:10:47 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#define _GNU_SOURCE
+#include "executor.h"
+#include "signals.h"
+#include <fcntl.h>
+
+// `set -o multios`: `cmd > a > b` writes to both files. The command's fd
+// is pointed at a pipe and a helper process copies everything it reads
+// from that pipe to each file. On Linux the copy never enters user
+// space: tee(2) duplicates the pipe contents into one private pipe per
+// extra file and splice(2) moves pipe pages into the files.
+
+#define FANOUT_CHUNK 65536
+
+typedef struct s_fan_out
+{
+	int	fd;
+	int	alive;		// 0 after a write error: data is discarded
+	int	splice;		// 0 when the file refuses splice (O_APPEND, tty)
+	int	pipe[2];	// tee target feeding this file
+}	t_fan_out;
+
+static char	g_buf[FANOUT_CHUNK];
+
+static int	write_all(int fd, const char *buf, ssize_t len)
+{
+	ssize_t	n;
+
+	while (len > 0)
+	{
+		n = write(fd, buf, len);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (n <= 0)
+			return (-1);
+		buf += n;
+		len -= n;
+	}
+	return (0);
+}
+
+// Move exactly len bytes out of pipe `from`, into out->fd while that
+// file still accepts data
+static void	drain_pipe(int from, t_fan_out *out, size_t len)
+{
+	ssize_t	n;
+
+	while (len > 0)
+	{
+		n = -1;
+#ifdef __linux__
+		if (out->alive && out->splice)
+		{
+			n = splice(from, NULL, out->fd, NULL, len, SPLICE_F_MOVE);
+			if (n < 0 && errno == EINVAL)
+				out->splice = 0;
+			else if (n < 0 && errno != EINTR)
+				out->alive = 0;
+		}
+#endif
+		if (n < 0)
+		{
+			n = read(from, g_buf, len < FANOUT_CHUNK ? len : FANOUT_CHUNK);
+			if (n < 0 && errno == EINTR)
+				continue ;
+			if (n > 0 && out->alive && write_all(out->fd, g_buf, n) < 0)
+				out->alive = 0;
+		}
+		if (n <= 0)
+			return ;
+		len -= n;
+	}
+}
+
+// Portable path: read once, write to every file
+static void	copy_fanout(int in, t_fan_out *outs, int count)
+{
+	ssize_t	n;
+	int	i;
+
+	while (1)
+	{
+		n = read(in, g_buf, FANOUT_CHUNK);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (n <= 0)
+			return ;
+		i = 0;
+		while (i < count)
+		{
+			if (outs[i].alive && write_all(outs[i].fd, g_buf, n) < 0)
+				outs[i].alive = 0;
+			i++;
+		}
+	}
+}
+
+#ifdef __linux__
+
+// One chunk: tee it into the private pipe of every file but the last,
+// drain those, then splice the original out of `in` into the last file.
+// Returns 0 at end of input, -1 when tee is unusable (nothing consumed).
+static int	tee_chunk(int in, t_fan_out *outs, int count)
+{
+	ssize_t	len;
+	ssize_t	n;
+	int	i;
+
+	len = 0;
+	i = 0;
+	while (i < count - 1)
+	{
+		n = tee(in, outs[i].pipe[1], i == 0 ? FANOUT_CHUNK : len, 0);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (i == 0 && n < 0)
+			return (-1);
+		if (i == 0 && n == 0)
+			return (0);
+		if (i == 0)
+			len = n;
+		if (n > 0)
+			drain_pipe(outs[i].pipe[0], &outs[i], n);
+		i++;
+	}
+	drain_pipe(in, &outs[count - 1], len);
+	return (1);
+}
+
+static void	splice_fanout(int in, t_fan_out *outs, int count)
+{
+	int	i;
+	int	status;
+
+	i = 0;
+	while (i < count - 1)
+	{
+		if (shell_pipe(outs[i].pipe) == -1)
+		{
+			while (i-- > 0)
+			{
+				close(outs[i].pipe[0]);
+				close(outs[i].pipe[1]);
+			}
+			copy_fanout(in, outs, count);
+			return ;
+		}
+		i++;
+	}
+	status = 1;
+	while (status == 1)
+		status = tee_chunk(in, outs, count);
+	if (status == -1)
+		copy_fanout(in, outs, count);
+}
+
+#endif
+
+// Body of the helper process: copy `in` to every file until EOF
+static void	run_fanout(int in, int *files, int count)
+{
+	t_fan_out	*outs;
+	int		i;
+
+	signal(SIGINT, SIG_DFL);
+	signal(SIGQUIT, SIG_DFL);
+	signal(SIGPIPE, SIG_IGN);
+	outs = malloc(sizeof(t_fan_out) * count);
+	if (!outs)
+		exit(1);
+	i = 0;
+	while (i < count)
+	{
+		outs[i].fd = files[i];
+		outs[i].alive = 1;
+		outs[i].splice = 1;
+		i++;
+	}
+#ifdef __linux__
+	splice_fanout(in, outs, count);
+#else
+	copy_fanout(in, outs, count);
+#endif
+	free(outs);
+}
+
+// Propagate the way the program ended, signals included
+static void	exit_like(int status)
+{
+	if (WIFSIGNALED(status))
+	{
+		signal(WTERMSIG(status), SIG_DFL);
+		kill(getpid(), WTERMSIG(status));
+	}
+	exit(decode_wait_status(status));
+}
+
+// Point fd at a pipe drained by a fan-out helper writing to files.
+// In the shell (state != NULL) the helper is a child that
+// restore_redirections() waits for. In a child about to exec, the
+// child itself turns into the helper and the program runs in a new
+// process below it, so whoever waits for us also waits for the copy.
+int	start_fanout(int fd, int *files, int count, t_redir_state *state)
+{
+	int	pipefd[2];
+	pid_t	pid;
+	int	status;
+
+	if (shell_pipe(pipefd) == -1)
+	{
+		perror("pipe");
+		return (1);
+	}
+	pid = shell_fork();
+	if (pid == -1)
+	{
+		perror("fork");
+		close(pipefd[0]);
+		close(pipefd[1]);
+		return (1);
+	}
+	if ((pid == 0) == (state != NULL))
+	{
+		close(pipefd[1]);
+		run_fanout(pipefd[0], files, count);
+		if (state)
+			exit(0);
+		waitpid(pid, &status, 0);
+		exit_like(status);
+	}
+	close(pipefd[0]);
+	if (state)
+		state->helpers[state->helper_count++] = pid;
+	if (dup2(pipefd[1], fd) == -1)
+	{
+		perror("dup2");
+		close(pipefd[1]);
+		return (1);
+	}
+	close(pipefd[1]);
+	return (0);
+}
@@ -0,0 +1,130 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fds.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:48:30 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:48:32 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#define _GNU_SOURCE
+#include "executor.h"
+#include <fcntl.h>
+#include <dirent.h>
+#ifdef __linux__
+# include <sys/syscall.h>
+# include <linux/close_range.h>
+#endif
+
+// Every fd the shell keeps for itself is close-on-exec, so programs we
+// run only ever inherit what a redirection or pipeline gave them on
+// purpose. dup2() onto 0/1/2 clears the flag on the copy.
+
+int	shell_pipe(int fds[2])
+{
+#ifdef __linux__
+	return (pipe2(fds, O_CLOEXEC));
+#else
+	if (pipe(fds) == -1)
+		return (-1);
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	return (0);
+#endif
+}
+
+// Largest capacity an unprivileged process may request
+static int	pipe_max_size(void)
+{
+	static int	max_size;
+	char		buf[32];
+	ssize_t		len;
+	int		fd;
+
+	if (max_size)
+		return (max_size);
+	max_size = 1 << 20;
+	fd = open("/proc/sys/fs/pipe-max-size", O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return (max_size);
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len > 0)
+	{
+		buf[len] = '\0';
+		if (ft_atoi(buf) > 0)
+			max_size = ft_atoi(buf);
+	}
+	return (max_size);
+}
+
+// Apply `set -o pipesize=N` to a freshly created pipeline pipe. Bigger
+// pipes let producer and consumer run longer between context switches.
+void	size_pipeline_pipe(int fds[2])
+{
+#ifdef F_SETPIPE_SZ
+	int	size;
+
+	size = get_shell()->pipe_size;
+	if (size <= 0)
+		return ;
+	if (size > pipe_max_size())
+		size = pipe_max_size();
+	fcntl(fds[1], F_SETPIPE_SZ, size);
+#else
+	(void)fds;
+#endif
+}
+
+// Private copy of fd, placed at 10 or above out of the way of
+// user redirections like 3<file
+int	shell_dup(int fd)
+{
+	return (fcntl(fd, F_DUPFD_CLOEXEC, 10));
+}
+
+// Safety net run in a child right before its redirections are applied:
+// anything above stderr that still lacks close-on-exec gets it now.
+void	cloexec_inherited_fds(void)
+{
+#if defined(__linux__) && defined(SYS_close_range)
+	syscall(SYS_close_range, 3U, ~0U, CLOSE_RANGE_CLOEXEC);
+#endif
+}
+
+// `set -o fdtrace`: list what the program about to be exec'd inherits
+void	trace_inherited_fds(const char *name)
+{
+	DIR		*dir;
+	struct dirent	*entry;
+	char		link[64];
+	char		target[256];
+	ssize_t		len;
+	int		fd;
+
+	if (!(get_shell()->options & OPT_FDTRACE))
+		return ;
+	dir = opendir("/proc/self/fd");
+	if (!dir)
+		return ;
+	fprintf(stderr, "minishell: fdtrace: %s:", name);
+	while ((entry = readdir(dir)))
+	{
+		if (!ft_isdigit(entry->d_name[0]))
+			continue ;
+		fd = ft_atoi(entry->d_name);
+		if (fd == dirfd(dir) || (fcntl(fd, F_GETFD) & FD_CLOEXEC))
+			continue ;
+		snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+		len = readlink(link, target, sizeof(target) - 1);
+		if (len < 0)
+			len = 0;
+		target[len] = '\0';
+		fprintf(stderr, " %d=%s", fd, target);
+	}
+	fprintf(stderr, "\n");
+	closedir(dir);
+}
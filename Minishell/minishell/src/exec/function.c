@@ -0,0 +1,120 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   function.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 19:58:02 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 19:58:04 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+
+// Shell functions. A definition keeps its own copy of the parsed body,
+// so a call just runs that tree in the shell process with a new set of
+// positional parameters. Entries are reference counted: a function
+// redefined or unset while it runs stays alive until the call returns.
+
+#define FUNC_SLOTS 64
+#define FUNC_MAX_DEPTH 1000
+
+static t_func	*g_funcs[FUNC_SLOTS];
+static int	g_func_count;
+
+static t_named	**slot(const char *name)
+{
+	return ((t_named **)&g_funcs[hash_text(name) % FUNC_SLOTS]);
+}
+
+static void	release(t_func *fn)
+{
+	if (--fn->refs > 0)
+		return ;
+	free(fn->name);
+	free_command(fn->body);
+	free(fn);
+}
+
+t_func	*find_function(const char *name)
+{
+	if (g_func_count == 0 || !name)
+		return (NULL);
+	return ((t_func *)*named_link(slot(name), name));
+}
+
+// Take name out of the table. Returns 1 if it was defined.
+int	unset_function(const char *name)
+{
+	t_named	**link;
+	t_func	*fn;
+
+	link = named_link(slot(name), name);
+	fn = (t_func *)*link;
+	if (!fn)
+		return (0);
+	*link = (*link)->next;
+	g_func_count--;
+	release(fn);
+	return (1);
+}
+
+// name() body: store a copy of body under name
+int	define_function(const char *name, t_command *body)
+{
+	t_func	*fn;
+
+	fn = malloc(sizeof(t_func));
+	if (!fn)
+		return (1);
+	fn->name = ft_strdup(name);
+	fn->body = copy_command(body);
+	fn->refs = 1;
+	if (!fn->name || !fn->body)
+	{
+		release(fn);
+		return (1);
+	}
+	unset_function(name);
+	fn->next = (t_func *)*slot(name);
+	*slot(name) = (t_named *)fn;
+	g_func_count++;
+	return (0);
+}
+
+// Run fn with cmd's words as $1.. and its redirections applied
+int	call_function(t_func *fn, t_simple_cmd *cmd, t_env *env)
+{
+	t_redir_state	state;
+	t_params	saved;
+	t_shell		*shell;
+	int		status;
+
+	shell = get_shell();
+	if (shell->func_depth >= FUNC_MAX_DEPTH)
+	{
+		fprintf(stderr, "minishell: %s: maximum function nesting level "
+			"exceeded (%d)\n", fn->name, FUNC_MAX_DEPTH);
+		return (1);
+	}
+	if (apply_redirections(cmd->redirs, &state) != 0)
+	{
+		restore_redirections(&state);
+		return (1);
+	}
+	saved = shell->params;
+	shell->params.argv = cmd->args + 1;
+	shell->params.argc = 0;
+	while (shell->params.argv[shell->params.argc])
+		shell->params.argc++;
+	fn->refs++;
+	shell->func_depth++;
+	status = execute_command(fn->body, env);
+	shell->func_depth--;
+	shell->returning = 0;
+	shell->params = saved;
+	release(fn);
+	restore_redirections(&state);
+	return (status);
+}
@@ -0,0 +1,348 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pathcache.c                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:58:13 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:58:15 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+#include <dirent.h>
+#include <limits.h>
+#include <fcntl.h>
+
+// Executables on PATH, as a prefix trie of their names. It is filled by
+// reading each PATH directory once, and thrown away when PATH changes
+// or a directory's mtime does, which is what adding, removing or
+// renaming a program in it changes. Command lookup checks the mtimes
+// every time; completion at most once per prompt, so Tab stats nothing
+// per program. Files that are not executable are kept too: chmod does
+// not touch the directory, so lookup only trusts a name whose first
+// file is executable now, and searches PATH the slow way otherwise.
+
+#define TRIE_BLOCK 4096
+
+// Children are kept sorted by byte, so a walk yields names in order
+typedef struct s_trie
+{
+	struct s_trie	*child;
+	struct s_trie	*sibling;
+	int		dir;	// first PATH entry with a file of the name, or -1
+	int		exec;	// one of those files was executable when read
+	char		c;
+}	t_trie;
+
+typedef struct s_trie_block
+{
+	struct s_trie_block	*next;
+	t_trie			nodes[TRIE_BLOCK];
+}	t_trie_block;
+
+typedef struct s_path_dir
+{
+	char		*path;
+	struct timespec	mtime;
+	int		exists;
+}	t_path_dir;
+
+typedef struct s_path_cache
+{
+	char		*path_env;	// the PATH it was built for
+	t_path_dir	*dirs;
+	int		count;
+	int		relative;	// an entry depends on the cwd: lookups bypass
+	t_trie		root;
+	t_trie_block	*blocks;
+	int		used;		// nodes taken from the first block
+	int		checked;	// mtimes checked since the last prompt
+}	t_path_cache;
+
+static t_path_cache	g_path;
+
+static t_trie	*new_node(char c)
+{
+	t_trie_block	*block;
+	t_trie		*node;
+
+	if (!g_path.blocks || g_path.used == TRIE_BLOCK)
+	{
+		block = malloc(sizeof(t_trie_block));
+		if (!block)
+			return (NULL);
+		block->next = g_path.blocks;
+		g_path.blocks = block;
+		g_path.used = 0;
+	}
+	node = &g_path.blocks->nodes[g_path.used++];
+	ft_bzero(node, sizeof(t_trie));
+	node->c = c;
+	node->dir = -1;
+	return (node);
+}
+
+// Child c of node; made when create is set
+static t_trie	*child(t_trie *node, char c, int create)
+{
+	t_trie	**link;
+	t_trie	*made;
+
+	link = &node->child;
+	while (*link && (unsigned char)(*link)->c < (unsigned char)c)
+		link = &(*link)->sibling;
+	if (*link && (*link)->c == c)
+		return (*link);
+	if (!create)
+		return (NULL);
+	made = new_node(c);
+	if (made)
+	{
+		made->sibling = *link;
+		*link = made;
+	}
+	return (made);
+}
+
+static t_trie	*find(const char *name, int create)
+{
+	t_trie	*node;
+
+	node = &g_path.root;
+	while (node && *name)
+		node = child(node, *name++, create);
+	return (node);
+}
+
+// Files of PATH entry i, other than directories
+static void	scan_dir(int i)
+{
+	DIR		*d;
+	struct dirent	*ent;
+	struct stat	st;
+	t_trie		*node;
+
+	d = opendir(g_path.dirs[i].path);
+	ent = NULL;
+	if (d)
+		ent = readdir(d);
+	while (ent)
+	{
+		if (ent->d_type != DT_DIR && ent->d_name[0] != '.'
+			&& ((ent->d_type != DT_LNK && ent->d_type != DT_UNKNOWN)
+				|| (fstatat(dirfd(d), ent->d_name, &st, 0) == 0
+					&& !S_ISDIR(st.st_mode))))
+		{
+			node = find(ent->d_name, 1);
+			if (node && node->dir < 0)
+				node->dir = i;
+			if (node && !node->exec)
+				node->exec = (faccessat(dirfd(d), ent->d_name, X_OK, 0) == 0);
+		}
+		ent = readdir(d);
+	}
+	if (d)
+		closedir(d);
+}
+
+static void	clear_cache(void)
+{
+	t_trie_block	*next;
+
+	while (g_path.blocks)
+	{
+		next = g_path.blocks->next;
+		free(g_path.blocks);
+		g_path.blocks = next;
+	}
+	while (g_path.count > 0)
+		free(g_path.dirs[--g_path.count].path);
+	free(g_path.dirs);
+	free(g_path.path_env);
+	ft_bzero(&g_path, sizeof(t_path_cache));
+}
+
+// Whether PATH entry i still has the mtime it was read with; refreshes
+// the recorded one
+static int	unchanged(t_path_dir *dir)
+{
+	struct stat	st;
+	int		exists;
+	int		same;
+
+	exists = (stat(dir->path, &st) == 0);
+	same = (exists == dir->exists);
+	if (exists)
+	{
+		same = same && st.st_mtim.tv_sec == dir->mtime.tv_sec
+			&& st.st_mtim.tv_nsec == dir->mtime.tv_nsec;
+		dir->mtime = st.st_mtim;
+	}
+	dir->exists = exists;
+	return (same);
+}
+
+// Read every entry of path_env; an empty one is the current directory
+static int	build(const char *path_env)
+{
+	const char	*colon;
+	size_t		len;
+
+	clear_cache();
+	g_path.root.dir = -1;
+	g_path.path_env = ft_strdup(path_env);
+	len = 1;
+	colon = path_env;
+	while (*colon)
+		len += (*colon++ == ':');
+	g_path.dirs = ft_calloc(len, sizeof(t_path_dir));
+	while (g_path.path_env && g_path.dirs && path_env)
+	{
+		colon = ft_strchr(path_env, ':');
+		len = ft_strlen(path_env);
+		if (colon)
+			len = colon - path_env;
+		if (len)
+			g_path.dirs[g_path.count].path = ft_substr(path_env, 0, len);
+		else
+			g_path.dirs[g_path.count].path = ft_strdup(".");
+		if (!g_path.dirs[g_path.count].path)
+			break ;
+		g_path.relative |= (g_path.dirs[g_path.count].path[0] != '/');
+		unchanged(&g_path.dirs[g_path.count]);
+		scan_dir(g_path.count++);
+		path_env = colon;
+		if (colon)
+			path_env = colon + 1;
+	}
+	if (path_env)
+		clear_cache();
+	return (path_env == NULL);
+}
+
+// Make the cache match the PATH of env; 0 when there is none. With
+// check, or on the first use after a prompt, the mtimes are compared.
+static int	cache_for(t_env *env, int check)
+{
+	char	*path_env;
+	int	same;
+	int	i;
+
+	path_env = get_env_value(env, "PATH");
+	if (!path_env || !*path_env)
+	{
+		clear_cache();
+		return (0);
+	}
+	same = (g_path.path_env && ft_strncmp(g_path.path_env, path_env,
+				ft_strlen(path_env) + 1) == 0);
+	i = 0;
+	while (same && (check || !g_path.checked) && i < g_path.count)
+		same = unchanged(&g_path.dirs[i++]);
+	if (!same && !build(path_env))
+		return (0);
+	g_path.checked = 1;
+	return (1);
+}
+
+// Next prompt: completion compares the mtimes again
+void	path_cache_expire(void)
+{
+	g_path.checked = 0;
+}
+
+// Full path of the program name runs, from the cache; NULL when it has
+// no usable answer and PATH must be searched
+char	*path_lookup(const char *name, t_env *env)
+{
+	t_trie	*node;
+	char	*dir;
+	char	*full;
+
+	if (!cache_for(env, 1) || g_path.relative)
+		return (NULL);
+	node = find(name, 0);
+	if (!node || node->dir < 0)
+		return (NULL);
+	dir = ft_strjoin(g_path.dirs[node->dir].path, "/");
+	full = NULL;
+	if (dir)
+		full = ft_strjoin(dir, name);
+	free(dir);
+	if (full && access(full, X_OK) != 0)
+	{
+		free(full);
+		full = NULL;
+	}
+	return (full);
+}
+
+typedef struct s_names
+{
+	char	**v;
+	size_t	count;
+	size_t	cap;
+}	t_names;
+
+// Add the names below node, whose first len bytes are in buf
+static int	collect(t_trie *node, char *buf, size_t len, t_names *out)
+{
+	char	**grown;
+
+	if (node->exec)
+	{
+		if (out->count + 1 >= out->cap)
+		{
+			out->cap = out->cap * 2 + 64;
+			grown = malloc(sizeof(char *) * out->cap);
+			if (!grown)
+				return (0);
+			if (out->v)
+				ft_memcpy(grown, out->v, sizeof(char *) * out->count);
+			free(out->v);
+			out->v = grown;
+		}
+		out->v[out->count] = ft_substr(buf, 0, len);
+		if (!out->v[out->count++])
+			return (0);
+		out->v[out->count] = NULL;
+	}
+	node = node->child;
+	while (node && len < NAME_MAX)
+	{
+		buf[len] = node->c;
+		if (!collect(node, buf, len + 1, out))
+			return (0);
+		node = node->sibling;
+	}
+	return (1);
+}
+
+// Programs on PATH whose name starts with prefix, sorted, as a new
+// NULL-terminated array (NULL when there are none)
+char	**path_complete(const char *prefix, t_env *env)
+{
+	t_names	out;
+	t_trie	*node;
+	char	buf[NAME_MAX + 1];
+	size_t	len;
+
+	len = ft_strlen(prefix);
+	if (len > NAME_MAX || !cache_for(env, 0))
+		return (NULL);
+	node = find(prefix, 0);
+	if (!node)
+		return (NULL);
+	ft_bzero(&out, sizeof(t_names));
+	ft_memcpy(buf, prefix, len);
+	if (!collect(node, buf, len, &out))
+	{
+		while (out.count > 0)
+			free(out.v[--out.count]);
+		free(out.v);
+		return (NULL);
+	}
+	return (out.v);
+}
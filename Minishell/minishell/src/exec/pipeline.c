@@ -0,0 +1,224 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pipeline.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 11:02:37 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 11:02:39 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+#include "expander.h"
+#include "signals.h"
+#include <fcntl.h>
+
+// Count the stages of a (right-nested) pipe chain
+static int	count_stages(t_command *cmd)
+{
+	int	count;
+
+	count = 1;
+	while (cmd->type == CMD_PIPE)
+	{
+		count++;
+		cmd = cmd->data.pipe_cmd.right;
+	}
+	return (count);
+}
+
+// Flatten a -> (b -> (c)) into [a, b, c]
+static t_command	**collect_stages(t_command *cmd, int count)
+{
+	t_command	**stages;
+	int		i;
+
+	stages = malloc(sizeof(t_command *) * count);
+	if (!stages)
+		return (NULL);
+	i = 0;
+	while (cmd->type == CMD_PIPE)
+	{
+		stages[i++] = cmd->data.pipe_cmd.left;
+		cmd = cmd->data.pipe_cmd.right;
+	}
+	stages[i] = cmd;
+	return (stages);
+}
+
+// Child side of one stage: wire stdin/stdout to the pipes and run it
+static void	run_stage_child(t_command *stage, int in_fd, int pipefd[2],
+		t_env *env)
+{
+	signal(SIGINT, SIG_DFL);
+	signal(SIGQUIT, SIG_DFL);
+	if (in_fd != -1)
+	{
+		if (dup2(in_fd, STDIN_FILENO) == -1)
+		{
+			perror("dup2");
+			exit(1);
+		}
+		close(in_fd);
+	}
+	if (pipefd[1] != -1)
+	{
+		close(pipefd[0]);
+		if (dup2(pipefd[1], STDOUT_FILENO) == -1)
+		{
+			perror("dup2");
+			exit(1);
+		}
+		close(pipefd[1]);
+	}
+	exit(execute_stage(stage, env));
+}
+
+// lastpipe: run the final stage in the shell itself with stdin read
+// from the pipe, then put the shell's stdin back.
+static int	run_last_stage_in_shell(t_command *stage, int in_fd, t_env *env)
+{
+	int	saved_stdin;
+	int	status;
+
+	saved_stdin = shell_dup(STDIN_FILENO);
+	if (saved_stdin == -1 || dup2(in_fd, STDIN_FILENO) == -1)
+	{
+		perror("dup2");
+		close(in_fd);
+		if (saved_stdin != -1)
+			close(saved_stdin);
+		return (1);
+	}
+	close(in_fd);
+	status = execute_command(stage, env);
+	// Dropping our read end lets writers still running get SIGPIPE
+	dup2(saved_stdin, STDIN_FILENO);
+	close(saved_stdin);
+	return (status);
+}
+
+// Fork every stage except, under lastpipe, the last one. Returns the
+// number of children started; *in_fd is left on the last pipe's read end.
+static int	spawn_stages(t_command **stages, int count, pid_t *pids,
+		int *in_fd, t_env *env)
+{
+	int	pipefd[2];
+	int	forked;
+	int	i;
+
+	forked = count;
+	if (get_shell()->options & OPT_LASTPIPE)
+		forked = count - 1;
+	i = 0;
+	while (i < forked)
+	{
+		pipefd[0] = -1;
+		pipefd[1] = -1;
+		if (i < count - 1 && shell_pipe(pipefd) == -1)
+		{
+			perror("pipe");
+			break ;
+		}
+		if (pipefd[1] != -1)
+			size_pipeline_pipe(pipefd);
+		pids[i] = shell_fork();
+		if (pids[i] == -1)
+		{
+			perror("fork");
+			if (pipefd[0] != -1)
+				close(pipefd[0]);
+			if (pipefd[1] != -1)
+				close(pipefd[1]);
+			break ;
+		}
+		if (pids[i] == 0)
+			run_stage_child(stages[i], *in_fd, pipefd, env);
+		if (*in_fd != -1)
+			close(*in_fd);
+		if (pipefd[1] != -1)
+			close(pipefd[1]);
+		*in_fd = pipefd[0];
+		i++;
+	}
+	return (i);
+}
+
+// The file of a leading `cat FILE' the optimizer marked, opened for the
+// next stage to read in its place, or -1 if it is not a regular file
+// that opens: then the cat runs, with its own error and status.
+static int	open_feed(t_command *cat)
+{
+	struct stat	st;
+	char		*file;
+	int		fd;
+
+	file = remove_quotes(cat->data.simple.args[1]);
+	if (!file)
+		return (-1);
+	fd = open(file, O_RDONLY | O_CLOEXEC);
+	free(file);
+	if (fd == -1)
+		return (-1);
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))
+	{
+		close(fd);
+		return (-1);
+	}
+	return (fd);
+}
+
+int	execute_pipe_command(t_command *cmd, t_env *env)
+{
+	t_command	**stages;
+	pid_t		*pids;
+	int		count;
+	int		started;
+	int		in_fd;
+	int		first;
+	int		status;
+	int		final_status;
+	int		i;
+
+	count = count_stages(cmd);
+	stages = collect_stages(cmd, count);
+	pids = malloc(sizeof(pid_t) * count);
+	if (!stages || !pids)
+	{
+		free(stages);
+		free(pids);
+		return (1);
+	}
+	in_fd = -1;
+	if (cmd->data.pipe_cmd.feed)
+		in_fd = open_feed(stages[0]);
+	first = (in_fd != -1);
+	started = spawn_stages(stages + first, count - first, pids, &in_fd, env);
+	final_status = 1;
+	if ((get_shell()->options & OPT_LASTPIPE)
+		&& started == count - first - 1 && in_fd != -1)
+		final_status = run_last_stage_in_shell(stages[count - 1], in_fd, env);
+	else if (in_fd != -1)
+		close(in_fd);
+
+	// Parent should ignore SIGINT/SIGQUIT while waiting for pipeline children
+	signal(SIGINT, SIG_IGN);
+	signal(SIGQUIT, SIG_IGN);
+	i = 0;
+	while (i < started)
+	{
+		waitpid(pids[i], &status, 0);
+		// Return exit status of the last command in the pipeline
+		if (i == count - first - 1)
+			final_status = decode_wait_status(status);
+		i++;
+	}
+	// Restore parent handlers
+	signal(SIGINT, handle_sigint);
+	signal(SIGQUIT, SIG_IGN);
+	free(stages);
+	free(pids);
+	return (final_status);
+}
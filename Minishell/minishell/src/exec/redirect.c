@@ -0,0 +1,395 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   redirect.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 12:05:10 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 12:05:12 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "executor.h"
+#include <fcntl.h>
+
+// One redirection engine for builtins, groups and exec'd children.
+//
+// The list is first compiled into a plan: a redirection whose fd is
+// replaced by a later one before anything reads it (`> a > b`) is
+// still opened, so files are created and errors reported, but it is
+// never dup'ed onto its fd. Only the fds the plan really changes are
+// backed up when the caller needs them restored.
+//
+// Under `set -o multios` several files sent to the same fd all stay
+// live and are fed from one pipe by a fan-out helper (see fanout.c).
+
+static void	print_redir_error(const char *name, const char *msg)
+{
+	fprintf(stderr, "minishell: %s: %s\n", name, msg);
+}
+
+// Parse the "m" of n>&m. Returns -1 when it is not a plain fd number.
+static int	parse_fd_word(const char *word)
+{
+	int	fd;
+	int	i;
+
+	if (!word || !word[0])
+		return (-1);
+	fd = 0;
+	i = 0;
+	while (word[i])
+	{
+		if (!ft_isdigit(word[i]) || i >= 4)
+			return (-1);
+		fd = fd * 10 + (word[i] - '0');
+		i++;
+	}
+	return (fd);
+}
+
+static int	reads_fd(t_redir *redir, int fd)
+{
+	return (redir->type == REDIR_DUP && parse_fd_word(redir->file) == fd);
+}
+
+// True when a later redirection takes over the same fd before any
+// n>&fd has had a chance to copy it.
+static int	is_overridden(t_redir *redir)
+{
+	t_redir	*next;
+
+	next = redir->next;
+	while (next)
+	{
+		if (reads_fd(next, redir->fd))
+			return (0);
+		if (next->fd == redir->fd)
+			return (1);
+		next = next->next;
+	}
+	return (0);
+}
+
+static int	is_file_output(t_redir *redir)
+{
+	return (redir->type == REDIR_OUT || redir->type == REDIR_APPEND
+		|| redir->type == REDIR_CLOBBER);
+}
+
+// multios: fd is sent to two or more files and nothing else, so every
+// one of those files gets the full output
+static int	wants_fanout(t_redir *redirs, int fd)
+{
+	int	outputs;
+
+	if (!(get_shell()->options & OPT_MULTIOS))
+		return (0);
+	outputs = 0;
+	while (redirs)
+	{
+		if (reads_fd(redirs, fd))
+			return (0);
+		if (redirs->fd == fd && !is_file_output(redirs))
+			return (0);
+		if (redirs->fd == fd)
+			outputs++;
+		redirs = redirs->next;
+	}
+	return (outputs >= 2);
+}
+
+static t_redir_step	*compile_plan(t_redir *redirs, int *count)
+{
+	t_redir_step	*steps;
+	t_redir		*it;
+	int		n;
+
+	n = 0;
+	it = redirs;
+	while (it && ++n)
+		it = it->next;
+	steps = malloc(sizeof(t_redir_step) * (n ? n : 1));
+	if (!steps)
+		return (NULL);
+	n = 0;
+	it = redirs;
+	while (it)
+	{
+		steps[n].redir = it;
+		steps[n].fanout = wants_fanout(redirs, it->fd);
+		steps[n].live = steps[n].fanout || !is_overridden(it);
+		steps[n].file_fd = -1;
+		n++;
+		it = it->next;
+	}
+	*count = n;
+	return (steps);
+}
+
+// `>` under noclobber refuses to truncate an existing regular file
+static int	open_noclobber(const char *path)
+{
+	struct stat	st;
+	int		fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	if (fd != -1 || errno != EEXIST)
+		return (fd);
+	if (stat(path, &st) == 0 && S_ISREG(st.st_mode))
+	{
+		errno = EEXIST;
+		return (-2);
+	}
+	return (open(path, O_WRONLY | O_CLOEXEC));
+}
+
+static int	open_redirect(t_redir *redir)
+{
+	int	fd;
+
+	if (redir->type == REDIR_HEREDOC)
+		return (handle_heredoc(redir->body));
+	if (redir->type == REDIR_IN)
+		fd = open(redir->file, O_RDONLY | O_CLOEXEC);
+	else if (redir->type == REDIR_RDWR)
+		fd = open(redir->file, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	else if (redir->type == REDIR_APPEND)
+		fd = open(redir->file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+				0644);
+	else if (redir->type == REDIR_OUT
+		&& (get_shell()->options & OPT_NOCLOBBER))
+		fd = open_noclobber(redir->file);
+	else
+		fd = open(redir->file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+				0644);
+	if (fd == -2)
+		print_redir_error(redir->file, "cannot overwrite existing file");
+	else if (fd == -1)
+		perror(redir->file);
+	return (fd < 0 ? -1 : fd);
+}
+
+// Remember what fd pointed to before the plan touches it
+static int	backup_fd(t_redir_state *state, int fd)
+{
+	int	i;
+
+	if (!state)
+		return (0);
+	i = 0;
+	while (i < state->count)
+		if (state->backups[i++].fd == fd)
+			return (0);
+	state->backups[state->count].fd = fd;
+	state->backups[state->count].saved = shell_dup(fd);
+	if (state->backups[state->count].saved == -1 && errno != EBADF)
+	{
+		perror("dup");
+		return (1);
+	}
+	state->count++;
+	return (0);
+}
+
+static int	apply_dup(t_redir *redir)
+{
+	int	src;
+
+	if (ft_strncmp(redir->file, "-", 2) == 0)
+	{
+		close(redir->fd);
+		return (0);
+	}
+	src = parse_fd_word(redir->file);
+	if (src < 0)
+	{
+		print_redir_error(redir->file, "ambiguous redirect");
+		return (1);
+	}
+	if (src != redir->fd && dup2(src, redir->fd) == -1)
+	{
+		print_redir_error(redir->file, strerror(errno));
+		return (1);
+	}
+	return (0);
+}
+
+static int	run_step(t_redir_step *step, t_redir_state *state)
+{
+	t_redir	*redir;
+	int	fd;
+
+	redir = step->redir;
+	if (redir->type == REDIR_DUP)
+	{
+		if (!step->live)
+			return (0);
+		if (backup_fd(state, redir->fd))
+			return (1);
+		return (apply_dup(redir));
+	}
+	if (step->live && backup_fd(state, redir->fd))
+		return (1);
+	fd = open_redirect(redir);
+	if (fd == -1)
+		return (1);
+	if (step->fanout)
+	{
+		step->file_fd = fd;
+		return (0);
+	}
+	if (!step->live)
+	{
+		close(fd);
+		return (0);
+	}
+	if (fd == redir->fd)
+	{
+		// Landed on its target directly: it must survive exec
+		fcntl(fd, F_SETFD, 0);
+		return (0);
+	}
+	if (dup2(fd, redir->fd) == -1)
+	{
+		perror("dup2");
+		close(fd);
+		return (1);
+	}
+	close(fd);
+	return (0);
+}
+
+// True for the first fan-out step of its fd, the one that starts the helper
+static int	leads_fanout(t_redir_step *steps, int i)
+{
+	int	j;
+
+	if (!steps[i].fanout)
+		return (0);
+	j = 0;
+	while (j < i)
+	{
+		if (steps[j].fanout && steps[j].redir->fd == steps[i].redir->fd)
+			return (0);
+		j++;
+	}
+	return (1);
+}
+
+// Hand the files of each fan-out fd to its helper
+static int	start_fanouts(t_redir_step *steps, int count, t_redir_state *state)
+{
+	int	*files;
+	int	status;
+	int	n;
+	int	i;
+	int	j;
+
+	files = malloc(sizeof(int) * count);
+	if (!files)
+		return (1);
+	status = 0;
+	i = 0;
+	while (i < count && status == 0)
+	{
+		if (leads_fanout(steps, i))
+		{
+			n = 0;
+			j = i;
+			while (j < count)
+			{
+				if (steps[j].fanout && steps[j].redir->fd == steps[i].redir->fd)
+					files[n++] = steps[j].file_fd;
+				j++;
+			}
+			status = start_fanout(steps[i].redir->fd, files, n, state);
+		}
+		i++;
+	}
+	free(files);
+	return (status);
+}
+
+static void	close_fanout_files(t_redir_step *steps, int count)
+{
+	while (count-- > 0)
+		if (steps[count].file_fd != -1)
+			close(steps[count].file_fd);
+}
+
+// Apply redirs to the current process. With a state, every fd that is
+// changed is backed up first so restore_redirections() can undo it;
+// children that are about to exec pass NULL and skip the backups.
+int	apply_redirections(t_redir *redirs, t_redir_state *state)
+{
+	t_redir_step	*steps;
+	int		count;
+	int		status;
+	int		i;
+
+	if (state)
+	{
+		state->backups = NULL;
+		state->count = 0;
+		state->helpers = NULL;
+		state->helper_count = 0;
+	}
+	if (!redirs)
+		return (0);
+	steps = compile_plan(redirs, &count);
+	if (!steps)
+		return (1);
+	if (state)
+	{
+		state->backups = malloc(sizeof(t_fd_backup) * count);
+		state->helpers = malloc(sizeof(pid_t) * count);
+		if (!state->backups || !state->helpers)
+		{
+			free(state->backups);
+			free(state->helpers);
+			state->backups = NULL;
+			free(steps);
+			return (1);
+		}
+	}
+	status = 0;
+	i = 0;
+	while (i < count && status == 0)
+		status = run_step(&steps[i++], state);
+	if (status == 0)
+		status = start_fanouts(steps, count, state);
+	close_fanout_files(steps, count);
+	free(steps);
+	return (status);
+}
+
+void	restore_redirections(t_redir_state *state)
+{
+	int	i;
+
+	if (!state->backups)
+		return ;
+	fflush(stdout);
+	fflush(stderr);
+	i = state->count;
+	while (i-- > 0)
+	{
+		if (state->backups[i].saved == -1)
+			close(state->backups[i].fd);
+		else
+		{
+			dup2(state->backups[i].saved, state->backups[i].fd);
+			close(state->backups[i].saved);
+		}
+	}
+	free(state->backups);
+	state->backups = NULL;
+	state->count = 0;
+	// Our copy of each fan-out pipe is gone: the helpers see EOF
+	while (state->helper_count > 0)
+		waitpid(state->helpers[--state->helper_count], NULL, 0);
+	free(state->helpers);
+	state->helpers = NULL;
+}
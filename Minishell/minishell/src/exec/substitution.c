@@ -0,0 +1,446 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   substitution.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 14:52:08 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 14:52:10 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#define _GNU_SOURCE
+#include "executor.h"
+#include "expander.h"
+#include "lexer.h"
+#include <fcntl.h>
+#ifdef __linux__
+# include <sys/mman.h>
+#endif
+
+#define SUBST_CACHE_SLOTS 64
+#define SUBST_CACHE_MAX 256
+
+// The inside of a $(...) or <(...) is lexed and parsed once and the
+// tree shared by every expansion of the same text, as $((...)) shares
+// its bytecode, so a loop does not parse its substitutions again on
+// each pass. Entries are reference counted like functions: one flushed
+// or replaced while it runs lives until the run ends. Aliases are
+// expanded as the text is lexed, so a change to them makes it stale.
+typedef struct s_subst_entry
+{
+	char			*name;	// the text; name and next as in t_named
+	struct s_subst_entry	*next;
+	t_command		*cmd;
+	int			aliases;	// alias_generation() when lexed
+	int			refs;	// the cache's plus one per run
+}	t_subst_entry;
+
+static t_subst_entry	*g_subst_cache[SUBST_CACHE_SLOTS];
+static int		g_subst_cached;
+
+static t_named	**slot(const char *text)
+{
+	return ((t_named **)&g_subst_cache[hash_text(text) % SUBST_CACHE_SLOTS]);
+}
+
+static void	release_entry(t_subst_entry *entry)
+{
+	if (!entry || --entry->refs > 0)
+		return ;
+	free(entry->name);
+	free_command(entry->cmd);
+	free(entry);
+}
+
+static void	flush_cache(void)
+{
+	t_subst_entry	*next;
+	int		i;
+
+	i = 0;
+	while (i < SUBST_CACHE_SLOTS)
+	{
+		while (g_subst_cache[i])
+		{
+			next = g_subst_cache[i]->next;
+			release_entry(g_subst_cache[i]);
+			g_subst_cache[i] = next;
+		}
+		i++;
+	}
+	g_subst_cached = 0;
+}
+
+// Lex and parse text, which the entry takes. NULL if it does not parse.
+static t_subst_entry	*parse_entry(char *text)
+{
+	t_subst_entry	*entry;
+	t_token		*tokens;
+
+	entry = ft_calloc(1, sizeof(t_subst_entry));
+	if (!entry)
+	{
+		free(text);
+		return (NULL);
+	}
+	entry->name = text;
+	entry->aliases = alias_generation();
+	entry->refs = 1;
+	tokens = lexer(text);
+	if (tokens)
+		entry->cmd = parse(tokens);
+	free_tokens(tokens);
+	if (!entry->cmd)
+	{
+		release_entry(entry);
+		return (NULL);
+	}
+	return (entry);
+}
+
+// The parsed inside of a substitution, from the cache or parsed now,
+// with a reference the caller releases. NULL when it does not parse.
+static t_subst_entry	*acquire(const char *body, size_t len)
+{
+	t_named		**link;
+	t_subst_entry	*entry;
+	char		*text;
+
+	text = ft_substr(body, 0, len);
+	if (!text)
+		return (NULL);
+	link = named_link(slot(text), text);
+	entry = (t_subst_entry *)*link;
+	if (entry && entry->aliases == alias_generation())
+	{
+		free(text);
+		entry->refs++;
+		return (entry);
+	}
+	if (entry)
+	{
+		*link = (*link)->next;
+		g_subst_cached--;
+		release_entry(entry);
+	}
+	entry = parse_entry(text);
+	if (!entry)
+		return (NULL);
+	if (g_subst_cached >= SUBST_CACHE_MAX)
+		flush_cache();
+	entry->next = (t_subst_entry *)*slot(entry->name);
+	*slot(entry->name) = (t_named *)entry;
+	g_subst_cached++;
+	entry->refs++;
+	return (entry);
+}
+
+// Child of a process substitution: its stdin or stdout is the pipe
+static void	run_procsub_child(t_subst_entry *entry, int output,
+		int pipefd[2], t_env *env)
+{
+	t_procsub	*it;
+	t_procsub	*next;
+
+	signal(SIGINT, SIG_DFL);
+	signal(SIGQUIT, SIG_DFL);
+	// Pipes of earlier substitutions belong to the command, not to us:
+	// close them and drop the copies of their nodes
+	it = get_shell()->procsubs;
+	while (it)
+	{
+		next = it->next;
+		close(it->fd);
+		free(it);
+		it = next;
+	}
+	get_shell()->procsubs = NULL;
+	get_shell()->procsub_count = 0;
+	if (dup2(pipefd[output ? 0 : 1], output ? STDIN_FILENO : STDOUT_FILENO)
+		== -1)
+	{
+		perror("dup2");
+		exit(1);
+	}
+	close(pipefd[0]);
+	close(pipefd[1]);
+	if (!entry)
+		exit(get_shell()->last_status);
+	exit(execute_command(entry->cmd, env));
+}
+
+static int	register_procsub(int fd, pid_t pid)
+{
+	t_procsub	*node;
+
+	node = malloc(sizeof(t_procsub));
+	if (!node)
+		return (0);
+	node->fd = fd;
+	node->pid = pid;
+	node->next = get_shell()->procsubs;
+	get_shell()->procsubs = node;
+	get_shell()->procsub_count++;
+	return (1);
+}
+
+// <(cmd) reads what cmd writes, >(cmd) feeds cmd's stdin. The shell's
+// end of the pipe is moved to fd 10 or above so user redirections such
+// as 3<file cannot clobber it, and the word becomes /dev/fd/N.
+char	*process_substitution(const char *body, size_t len, int output,
+		t_env *env)
+{
+	t_subst_entry	*entry;
+	int		pipefd[2];
+	pid_t		pid;
+	int		fd;
+	char		*num;
+	char		*path;
+
+	if (shell_pipe(pipefd) == -1)
+	{
+		perror("pipe");
+		return (NULL);
+	}
+	entry = acquire(body, len);
+	pid = shell_fork();
+	if (pid == 0)
+		run_procsub_child(entry, output, pipefd, env);
+	release_entry(entry);
+	fd = shell_dup(pipefd[output ? 1 : 0]);
+	close(pipefd[0]);
+	close(pipefd[1]);
+	if (pid == -1 || fd == -1)
+	{
+		perror(pid == -1 ? "fork" : "dup");
+		if (fd != -1)
+			close(fd);
+		return (NULL);
+	}
+	if (!register_procsub(fd, pid))
+	{
+		close(fd);
+		return (NULL);
+	}
+	num = ft_itoa(fd);
+	path = NULL;
+	if (num)
+		path = ft_strjoin("/dev/fd/", num);
+	free(num);
+	return (path);
+}
+
+// Close the shell's ends of the substitutions started since mark and
+// wait for them. Closing first lets `head -1 <(yes)` finish.
+void	reap_process_substitutions(int mark)
+{
+	t_shell		*shell;
+	t_procsub	*node;
+
+	shell = get_shell();
+	while (shell->procsub_count > mark && shell->procsubs)
+	{
+		node = shell->procsubs;
+		close(node->fd);
+		shell->procsubs = node->next;
+		shell->procsub_count--;
+		waitpid(node->pid, NULL, 0);
+		free(node);
+	}
+}
+
+// In a child about to exec: the /dev/fd/N paths in argv must stay valid
+void	keep_process_substitutions_open(void)
+{
+	t_procsub	*it;
+
+	it = get_shell()->procsubs;
+	while (it)
+	{
+		fcntl(it->fd, F_SETFD, 0);
+		it = it->next;
+	}
+}
+
+// Read fd to EOF into a string, dropping trailing newlines as $(...) does
+static char	*read_output(int fd)
+{
+	char	*buf;
+	char	*grown;
+	size_t	len;
+	size_t	cap;
+	ssize_t	n;
+
+	cap = 256;
+	len = 0;
+	buf = malloc(cap);
+	while (buf)
+	{
+		if (len + 1 == cap)
+		{
+			grown = malloc(cap * 2);
+			if (grown)
+				ft_memcpy(grown, buf, len);
+			free(buf);
+			buf = grown;
+			cap *= 2;
+			continue ;
+		}
+		n = read(fd, buf + len, cap - len - 1);
+		if (n < 0 && errno == EINTR)
+			continue ;
+		if (n <= 0)
+			break ;
+		len += n;
+	}
+	if (!buf)
+		return (NULL);
+	while (len > 0 && buf[len - 1] == '\n')
+		len--;
+	buf[len] = '\0';
+	return (buf);
+}
+
+// Whether no word of cmd can assign a variable as it is expanded
+static int	has_pure_words(t_simple_cmd *cmd)
+{
+	t_redir	*redir;
+
+	if (words_assign(cmd->args) || words_assign(cmd->assigns))
+		return (0);
+	redir = cmd->redirs;
+	while (redir)
+	{
+		if (redir->type != REDIR_HEREDOC && word_assigns(redir->file))
+			return (0);
+		redir = redir->next;
+	}
+	return (1);
+}
+
+// Builtins that only print, with words that assign nothing: running
+// them in the shell itself cannot leak state out of the substitution
+static int	is_pure_builtin_list(t_command *cmd)
+{
+	char	*name;
+	int	pure;
+
+	if (cmd && cmd->type == CMD_LIST)
+		return (is_pure_builtin_list(cmd->data.list.left)
+			&& is_pure_builtin_list(cmd->data.list.right));
+	if (!cmd || cmd->type != CMD_SIMPLE || !cmd->data.simple.args
+		|| ft_strchr(cmd->data.simple.args[0], '$')
+		|| !has_pure_words(&cmd->data.simple))
+		return (0);
+	name = remove_quotes(cmd->data.simple.args[0]);
+	if (!name)
+		return (0);
+	pure = !find_function(name) && (ft_strncmp(name, "echo", 5) == 0
+			|| ft_strncmp(name, "pwd", 4) == 0
+			|| ft_strncmp(name, "env", 4) == 0);
+	free(name);
+	return (pure);
+}
+
+// $(echo ...), $(pwd): run in the shell with stdout on an in-memory
+// file instead of forking. Returns NULL (nothing run) when unavailable.
+static char	*capture_in_process(t_command *cmd, t_env *env, int *status)
+{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+	char	*out;
+	int	saved;
+	int	memfd;
+
+	memfd = memfd_create("minishell-subst", MFD_CLOEXEC);
+	if (memfd == -1)
+		return (NULL);
+	fflush(stdout);
+	saved = shell_dup(STDOUT_FILENO);
+	if (dup2(memfd, STDOUT_FILENO) == -1)
+	{
+		close(memfd);
+		if (saved != -1)
+			close(saved);
+		return (NULL);
+	}
+	*status = execute_command(cmd, env);
+	fflush(stdout);
+	if (saved != -1)
+		dup2(saved, STDOUT_FILENO);
+	else
+		close(STDOUT_FILENO);
+	if (saved != -1)
+		close(saved);
+	lseek(memfd, 0, SEEK_SET);
+	out = read_output(memfd);
+	close(memfd);
+	return (out);
+#else
+	(void)cmd;
+	(void)env;
+	(void)status;
+	return (NULL);
+#endif
+}
+
+// Everything else runs in a child writing to a pipe we drain
+static char	*capture_in_child(t_command *cmd, t_env *env, int *status)
+{
+	int	pipefd[2];
+	pid_t	pid;
+	char	*out;
+
+	if (shell_pipe(pipefd) == -1)
+	{
+		perror("pipe");
+		return (NULL);
+	}
+	pid = shell_fork();
+	if (pid == 0)
+	{
+		signal(SIGINT, SIG_DFL);
+		signal(SIGQUIT, SIG_DFL);
+		close(pipefd[0]);
+		if (dup2(pipefd[1], STDOUT_FILENO) == -1)
+			exit(1);
+		close(pipefd[1]);
+		exit(execute_command(cmd, env));
+	}
+	close(pipefd[1]);
+	if (pid == -1)
+	{
+		perror("fork");
+		close(pipefd[0]);
+		return (NULL);
+	}
+	out = read_output(pipefd[0]);
+	close(pipefd[0]);
+	if (waitpid(pid, status, 0) == pid)
+		*status = decode_wait_status(*status);
+	return (out);
+}
+
+// $(cmd): the output of cmd without its trailing newlines. Its status
+// becomes $?, which a line of assignments returns.
+char	*command_substitution(const char *body, size_t len, t_env *env)
+{
+	t_subst_entry	*entry;
+	char		*out;
+	int		status;
+
+	entry = acquire(body, len);
+	out = NULL;
+	status = get_shell()->last_status;
+	if (entry && is_pure_builtin_list(entry->cmd))
+		out = capture_in_process(entry->cmd, env, &status);
+	if (entry && !out)
+		out = capture_in_child(entry->cmd, env, &status);
+	get_shell()->last_status = status;
+	get_shell()->subst_count++;
+	release_entry(entry);
+	if (!out)
+		out = ft_strdup("");
+	return (out);
+}
@@ -0,0 +1,416 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   brace.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:48:25 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 17:48:27 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "expander.h"
+
+// Brace expansion: `pre{a,b}post`, `{1..10}`, `{01..10..3}`, `{a..e}`,
+// nested as deep as needed. A word is parsed once into a small tree
+// whose nodes know how many words they produce, so the caller can size
+// argv up front; the k-th word is then built directly from the tree
+// (mixed radix over the parts) with no intermediate word lists.
+
+#define BRACE_MAX_WORDS 16777216
+
+static t_brace	*parse_seq(const char *s, int start, int end, int *error);
+
+static t_brace	*new_node(int type)
+{
+	t_brace	*node;
+
+	node = ft_calloc(1, sizeof(t_brace));
+	if (node)
+		node->type = type;
+	return (node);
+}
+
+void	brace_free(t_brace *node)
+{
+	int	i;
+
+	if (!node)
+		return ;
+	i = 0;
+	while (i < node->nkids)
+		brace_free(node->kids[i++]);
+	free(node->kids);
+	free(node);
+}
+
+static int	add_kid(t_brace *node, t_brace *kid)
+{
+	t_brace	**grown;
+
+	if (!kid)
+		return (0);
+	grown = malloc(sizeof(t_brace *) * (node->nkids + 1));
+	if (!grown)
+	{
+		brace_free(kid);
+		return (0);
+	}
+	if (node->kids)
+		ft_memcpy(grown, node->kids, sizeof(t_brace *) * node->nkids);
+	free(node->kids);
+	node->kids = grown;
+	node->kids[node->nkids++] = kid;
+	return (1);
+}
+
+// Index past a quote, `${...}` or `$(...)` starting at s[i], or i when
+// there is none there
+static int	skip_opaque(const char *s, int i, int end)
+{
+	int	j;
+
+	if (s[i] == '\'' || s[i] == '"')
+	{
+		j = i + 1;
+		while (j < end && s[j] != s[i])
+		{
+			if (s[i] == '"' && s[j] == '$' && (s[j + 1] == '('
+					|| s[j + 1] == '{') && match_paren(s, j + 1) != -1)
+				j = match_paren(s, j + 1) - 1;
+			j++;
+		}
+		return (j < end ? j + 1 : end);
+	}
+	if (s[i] == '$' && (s[i + 1] == '(' || s[i + 1] == '{'))
+	{
+		j = match_paren(s, i + 1);
+		if (j != -1 && j <= end)
+			return (j);
+	}
+	return (i);
+}
+
+// `-?digits` filling s[start..end)
+static int	is_number(const char *s, int start, int end)
+{
+	start += (s[start] == '-' && start + 1 < end);
+	if (start >= end)
+		return (0);
+	while (start < end && ft_isdigit(s[start]))
+		start++;
+	return (start == end);
+}
+
+// Length of the number or character at s[start], given it runs until
+// the next ".." or end
+static int	range_item(const char *s, int start, int end)
+{
+	int	len;
+
+	len = 0;
+	while (start + len < end && ft_strncmp(s + start + len, "..", 2) != 0)
+		len++;
+	if (len == 1 && !ft_isdigit(s[start]))
+		return (1);
+	return (is_number(s, start, start + len) ? len : 0);
+}
+
+static int	zero_padded(const char *s, int len)
+{
+	int	neg;
+
+	neg = (s[0] == '-');
+	return (len - neg > 1 && s[neg] == '0');
+}
+
+// Words in from..to by step (the sign of step is ignored)
+static void	set_range(t_brace *node, long long from, long long to,
+		long long step)
+{
+	unsigned long long	span;
+	unsigned long long	by;
+
+	node->from = from;
+	by = step < 0 ? 0ULL - (unsigned long long)step : (unsigned long long)step;
+	if (by == 0)
+		by = 1;
+	if (from <= to)
+		span = (unsigned long long)to - (unsigned long long)from;
+	else
+		span = (unsigned long long)from - (unsigned long long)to;
+	node->step = (long long)by;
+	if (from > to)
+		node->step = -node->step;
+	node->count = span / by + 1;
+	if (span / by >= BRACE_MAX_WORDS)
+		node->count = (size_t)BRACE_MAX_WORDS + 1;
+}
+
+// {x..y} or {x..y..step} filling s[start..end), or NULL. When either
+// number has a leading zero, every word is zero-padded to the longer.
+static t_brace	*parse_range(const char *s, int start, int end)
+{
+	t_brace		*node;
+	long long	step;
+	int		a;
+	int		b;
+	int		y;
+
+	a = range_item(s, start, end);
+	if (!a || ft_strncmp(s + start + a, "..", 2) != 0)
+		return (NULL);
+	y = start + a + 2;
+	b = range_item(s, y, end);
+	if (!b || (a == 1 && !ft_isdigit(s[start]))
+		!= (b == 1 && !ft_isdigit(s[y])))
+		return (NULL);
+	if (y + b != end && (ft_strncmp(s + y + b, "..", 2) != 0
+			|| !is_number(s, y + b + 2, end)))
+		return (NULL);
+	node = new_node(BRACE_RANGE);
+	if (!node)
+		return (NULL);
+	node->is_char = (a == 1 && !ft_isdigit(s[start]));
+	step = 1;
+	if (y + b != end)
+		step = strtoll(s + y + b + 2, NULL, 10);
+	if (node->is_char)
+		set_range(node, (unsigned char)s[start], (unsigned char)s[y], step);
+	else
+		set_range(node, strtoll(s + start, NULL, 10),
+			strtoll(s + y, NULL, 10), step);
+	if (!node->is_char && (zero_padded(s + start, a) || zero_padded(s + y, b)))
+		node->width = (a > b) ? a : b;
+	return (node);
+}
+
+// Index of the '}' closing the '{' at s[i], or -1. *commas counts the
+// commas directly inside it.
+static int	group_end(const char *s, int i, int end, int *commas)
+{
+	int	depth;
+	int	j;
+	int	next;
+
+	depth = 0;
+	*commas = 0;
+	j = i;
+	while (j < end)
+	{
+		next = skip_opaque(s, j, end);
+		if (next != j)
+		{
+			j = next;
+			continue ;
+		}
+		if (s[j] == '{')
+			depth++;
+		else if (s[j] == '}' && --depth == 0)
+			return (j);
+		else if (s[j] == ',' && depth == 1)
+			(*commas)++;
+		j++;
+	}
+	return (-1);
+}
+
+// The alternatives of the group s[start..end) (without its braces)
+static t_brace	*parse_alternatives(const char *s, int start, int end,
+		int *error)
+{
+	t_brace	*node;
+	int	piece;
+	int	j;
+	int	commas;
+
+	node = new_node(BRACE_ALT);
+	piece = start;
+	j = start;
+	while (node && !*error && j <= end)
+	{
+		if (j < end && skip_opaque(s, j, end) != j)
+			j = skip_opaque(s, j, end);
+		else if (j < end && s[j] == '{' && group_end(s, j, end, &commas) != -1)
+			j = group_end(s, j, end, &commas) + 1;
+		else if (j == end || s[j] == ',')
+		{
+			if (!add_kid(node, parse_seq(s, piece, j, error)))
+				*error = 1;
+			else
+				node->count += node->kids[node->nkids - 1]->count;
+			if (node->count > BRACE_MAX_WORDS)
+				*error = 2;
+			piece = ++j;
+		}
+		else
+			j++;
+	}
+	return (node);
+}
+
+// A group at s[i]: its node and *next past the '}', or NULL when the
+// braces are literal
+static t_brace	*parse_group(const char *s, int i, int end, int *next,
+		int *error)
+{
+	t_brace	*node;
+	int	close;
+	int	commas;
+
+	if (s[i] != '{' || (i > 0 && s[i - 1] == '$'))
+		return (NULL);
+	close = group_end(s, i, end, &commas);
+	if (close == -1)
+		return (NULL);
+	if (commas)
+		node = parse_alternatives(s, i + 1, close, error);
+	else
+		node = parse_range(s, i + 1, close);
+	if (node)
+		*next = close + 1;
+	return (node);
+}
+
+static int	add_text(t_brace *seq, const char *s, int start, int end)
+{
+	t_brace	*text;
+
+	if (start == end)
+		return (1);
+	text = new_node(BRACE_TEXT);
+	if (text)
+	{
+		text->text = s + start;
+		text->len = end - start;
+		text->count = 1;
+	}
+	return (add_kid(seq, text));
+}
+
+// Parts of s[start..end) in order; the word count is their product
+static t_brace	*parse_seq(const char *s, int start, int end, int *error)
+{
+	t_brace	*seq;
+	t_brace	*group;
+	int	text;
+	int	next;
+
+	seq = new_node(BRACE_SEQ);
+	if (!seq)
+		return (NULL);
+	seq->count = 1;
+	text = start;
+	while (!*error && start < end)
+	{
+		next = skip_opaque(s, start, end);
+		group = NULL;
+		if (next == start)
+			group = parse_group(s, start, end, &next, error);
+		if (next == start)
+			next = start + 1;
+		if (group && (!add_text(seq, s, text, start) || !add_kid(seq, group)))
+			*error = 1;
+		else if (group && seq->count > BRACE_MAX_WORDS / group->count)
+			*error = 2;
+		else if (group)
+		{
+			seq->count *= group->count;
+			seq->grouped = 1;
+			text = next;
+		}
+		start = next;
+	}
+	if (!*error && !add_text(seq, s, text, end))
+		*error = 1;
+	return (seq);
+}
+
+// Append the k-th word of node to sb. In a sequence the last part
+// varies fastest: `{a,b}{1,2}` is a1 a2 b1 b2.
+static int	append_nth(t_strbuf *sb, t_brace *node, size_t k)
+{
+	char	buf[32];
+	size_t	stride;
+	int	i;
+
+	if (node->type == BRACE_TEXT)
+		return (sb_append(sb, node->text, node->len));
+	if (node->type == BRACE_RANGE && node->is_char)
+	{
+		buf[0] = (char)(node->from + (long long)k * node->step);
+		return (sb_append(sb, buf, 1));
+	}
+	if (node->type == BRACE_RANGE)
+		return (sb_append(sb, buf, snprintf(buf, sizeof(buf), "%0*lld",
+					node->width, node->from + (long long)k * node->step)));
+	i = 0;
+	if (node->type == BRACE_ALT)
+	{
+		while (k >= node->kids[i]->count)
+			k -= node->kids[i++]->count;
+		return (append_nth(sb, node->kids[i], k));
+	}
+	stride = node->count;
+	while (i < node->nkids)
+	{
+		stride /= node->kids[i]->count;
+		if (!append_nth(sb, node->kids[i], (k / stride) % node->kids[i]->count))
+			return (0);
+		i++;
+	}
+	return (1);
+}
+
+// Write the words of tree to out in order, skipping empty ones.
+// Returns how many were written.
+size_t	brace_fill(t_brace *tree, char **out)
+{
+	t_strbuf	sb;
+	size_t		written;
+	size_t		k;
+
+	ft_bzero(&sb, sizeof(sb));
+	written = 0;
+	k = 0;
+	while (k < tree->count)
+	{
+		sb.len = 0;
+		if (!append_nth(&sb, tree, k++))
+			break ;
+		if (sb.len == 0)
+			continue ;
+		out[written] = malloc(sb.len + 1);
+		if (!out[written])
+			break ;
+		ft_memcpy(out[written++], sb.data, sb.len + 1);
+	}
+	free(sb.data);
+	return (written);
+}
+
+// Parse word. *tree is NULL when the word has no brace expansion;
+// *count is the number of words it expands to. Returns 0 on error.
+int	brace_parse(const char *word, t_brace **tree, size_t *count)
+{
+	int	error;
+
+	*tree = NULL;
+	*count = 1;
+	if (!ft_strchr(word, '{'))
+		return (1);
+	error = 0;
+	*tree = parse_seq(word, 0, ft_strlen(word), &error);
+	if (error == 2)
+		fprintf(stderr, "minishell: brace expansion: more than %d words\n",
+			BRACE_MAX_WORDS);
+	if (error || !*tree || !(*tree)->grouped)
+	{
+		brace_free(*tree);
+		*tree = NULL;
+		return (!error);
+	}
+	*count = (*tree)->count;
+	return (1);
+}
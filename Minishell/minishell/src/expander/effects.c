@@ -0,0 +1,100 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   effects.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 10:41:19 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 10:41:21 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "expander.h"
+
+// Whether expanding a word can assign a variable, for the callers that
+// run a command in the shell process only when it leaves no trace
+// there. The scan is textual and errs on the safe side: quoting is not
+// looked at, so `'${a=b}'` counts too and merely costs a fork.
+
+// Whether the arithmetic text s[0..len) assigns: `=` that is not part
+// of ==, !=, <= or >= (but is of <<= and >>=), `++` or `--`
+static int	arith_assigns(const char *s, size_t len)
+{
+	size_t	i;
+
+	i = 0;
+	while (i < len)
+	{
+		if ((s[i] == '+' || s[i] == '-') && i + 1 < len && s[i + 1] == s[i])
+			return (1);
+		if (s[i] == '=' && !(i + 1 < len && s[i + 1] == '=')
+			&& !(i > 0 && ft_strchr("=!<>", s[i - 1])
+				&& !(i > 1 && (s[i - 1] == '<' || s[i - 1] == '>')
+					&& s[i - 2] == s[i - 1])))
+			return (1);
+		i++;
+	}
+	return (0);
+}
+
+// Length of the $((...)) body at s (just past the `((`), up to the
+// parenthesis that closes it
+static size_t	arith_len(const char *s)
+{
+	size_t	i;
+	int	depth;
+
+	i = 0;
+	depth = 2;
+	while (s[i])
+	{
+		depth += (s[i] == '(') - (s[i] == ')');
+		if (depth == 0)
+			break ;
+		i++;
+	}
+	return (i);
+}
+
+// ${name=word} or ${name:=word} at s (just past the `{`)
+static int	param_assigns(const char *s)
+{
+	size_t	i;
+
+	i = 0;
+	while (ft_isalnum(s[i]) || s[i] == '_')
+		i++;
+	if (i == 0)
+		return (0);
+	if (s[i] == ':')
+		i++;
+	return (s[i] == '=');
+}
+
+int	word_assigns(const char *word)
+{
+	size_t	i;
+
+	i = 0;
+	while (word && word[i])
+	{
+		if (word[i] == '$' && word[i + 1] == '(' && word[i + 2] == '('
+			&& arith_assigns(word + i + 3, arith_len(word + i + 3)))
+			return (1);
+		if (word[i] == '$' && word[i + 1] == '{' && param_assigns(word + i + 2))
+			return (1);
+		i++;
+	}
+	return (0);
+}
+
+int	words_assign(char **words)
+{
+	while (words && *words)
+	{
+		if (word_assigns(*words++))
+			return (1);
+	}
+	return (0);
+}
@@ -11,156 +11,679 @@
 /* ************************************************************************** */
 
 #include "expander.h"
+#include "arith.h"
 
-static char	*expand_variable(char *str, t_env *env, int exit_status)
+static int	needs_escape(char c, int level)
+{
+	if (c == '\\' || c == FIELD_BREAK[0])
+		return (1);
+	if ((level & ESCAPE_META) && (c == '*' || c == '?' || c == '['))
+		return (1);
+	return ((level & ESCAPE_IFS) && ifs_member(c));
+}
+
+// Append with a backslash before each character the escape level of
+// sb covers, so that pattern matching takes them literally
+static int	sb_append_escaped(t_strbuf *sb, const char *src, size_t n)
+{
+	size_t	run;
+	int	level;
+	int	ok;
+
+	level = sb->escape;
+	sb->escape = 0;
+	ok = 1;
+	while (ok && n > 0)
+	{
+		run = 0;
+		while (run < n && !needs_escape(src[run], level))
+			run++;
+		ok = sb_append(sb, src, run);
+		if (ok && run < n)
+		{
+			ok = sb_append(sb, "\\", 1) && sb_append(sb, src + run, 1);
+			run++;
+		}
+		src += run;
+		n -= run;
+	}
+	sb->escape = level;
+	return (ok);
+}
+
+int	sb_append(t_strbuf *sb, const char *src, size_t n)
+{
+	char	*grown;
+	size_t	new_cap;
+
+	if (sb->escape)
+		return (sb_append_escaped(sb, src, n));
+	if (sb->len + n + 1 > sb->cap)
+	{
+		new_cap = sb->cap ? sb->cap : 32;
+		while (sb->len + n + 1 > new_cap)
+			new_cap *= 2;
+		grown = malloc(new_cap);
+		if (!grown)
+			return (0);
+		if (sb->data)
+			ft_memcpy(grown, sb->data, sb->len);
+		free(sb->data);
+		sb->data = grown;
+		sb->cap = new_cap;
+	}
+	ft_memcpy(sb->data + sb->len, src, n);
+	sb->len += n;
+	sb->data[sb->len] = '\0';
+	return (1);
+}
+
+// Expand the parameter starting right after a '$' at str[*i].
+static void	expand_variable(t_strbuf *sb, char *str, int *i, t_env *env,
+		int exit_status)
 {
-	char	*result;
 	char	*var_name;
 	char	*var_value;
-	int	i;
+	char	buf[16];
+	int	start;
+
+	if (str[*i] == '{')
+		expand_parameter(sb, str, i, env, exit_status);
+	else if (ft_isdigit(str[*i]) || str[*i] == '#')
+	{
+		var_value = positional_value(str + *i, 1, buf, sizeof(buf));
+		if (var_value)
+			sb_append(sb, var_value, ft_strlen(var_value));
+		(*i)++;
+	}
+	else if (str[*i] == '@' || str[*i] == '*')
+		append_positional(sb, str[(*i)++]);
+	else if (str[*i] == '?')
+	{
+		char *exit_str = ft_itoa(exit_status);
+		if (exit_str)
+			sb_append(sb, exit_str, ft_strlen(exit_str));
+		free(exit_str);
+		(*i)++;
+	}
+	else if (ft_isalpha(str[*i]) || str[*i] == '_')
+	{
+		start = *i;
+		while (str[*i] && (ft_isalnum(str[*i]) || str[*i] == '_'))
+			(*i)++;
+		var_name = ft_substr(str, start, *i - start);
+		var_value = NULL;
+		if (var_name)
+			var_value = get_env_value(env, var_name);
+		if (var_value)
+			sb_append(sb, var_value, ft_strlen(var_value));
+		free(var_name);
+	}
+	else
+	{
+		// '$' at end of string or followed by an invalid character
+		sb_append(sb, "$", 1);
+	}
+}
+
+// Copy a run of characters that need no special handling
+static void	append_literal(t_strbuf *sb, char *str, int *i)
+{
 	int	start;
-	char	*temp_result;
 
-	result = ft_strdup("");
-	if (!result)
+	start = *i;
+	while (str[*i] && str[*i] != '$' && str[*i] != '\''
+		&& str[*i] != '"' && str[*i] != '<' && str[*i] != '>')
+		(*i)++;
+	if (*i == start)
+		(*i)++;
+	sb_append(sb, str + start, *i - start);
+}
+
+// Replace the <(cmd) or >(cmd) starting at str[*i] with its /dev/fd path
+static void	expand_process_sub(t_strbuf *sb, char *str, int *i, t_env *env)
+{
+	char	*path;
+	int	end;
+
+	end = match_paren(str, *i + 1);
+	if (end == -1)
+	{
+		append_literal(sb, str, i);
+		return ;
+	}
+	path = process_substitution(str + *i + 2, end - *i - 3, str[*i] == '>',
+			env);
+	if (path)
+		sb_append(sb, path, ft_strlen(path));
+	free(path);
+	*i = end;
+}
+
+// Only `$(`, `${`, `$?` and quotes need the expander; plain `$name`
+// is read by the arithmetic code itself so the text stays cacheable.
+static int	arith_needs_expansion(const char *text)
+{
+	while (*text)
+	{
+		if (*text == '\'' || *text == '"')
+			return (1);
+		if (text[0] == '$' && !ft_isalpha(text[1]) && text[1] != '_')
+			return (1);
+		text++;
+	}
+	return (0);
+}
+
+// $(( expr )) with expr = str[start..start+len)
+static void	expand_arith(t_strbuf *sb, char *str, int start, int len,
+		t_env *env)
+{
+	long long	value;
+	char		*text;
+	char		*expanded;
+	char		buf[24];
+
+	text = ft_substr(str, start, len);
+	if (text && arith_needs_expansion(text))
+	{
+		expanded = expand_word(text, env, get_shell()->last_status);
+		free(text);
+		text = expanded;
+	}
+	if (!text || arith_eval(text, env, &value) != 0)
+		sb->failed = 1;
+	else
+	{
+		snprintf(buf, sizeof(buf), "%lld", value);
+		sb_append(sb, buf, ft_strlen(buf));
+	}
+	free(text);
+}
+
+// Replace the $(cmd) whose '(' is at str[*i] with the output of cmd, or
+// $((expr)) with its value
+static void	expand_command_sub(t_strbuf *sb, char *str, int *i, t_env *env)
+{
+	char	*out;
+	int	end;
+
+	end = match_paren(str, *i);
+	if (end == -1)
+	{
+		sb_append(sb, "$", 1);
+		return ;
+	}
+	if (str[*i + 1] == '(' && match_paren(str, *i + 1) == end - 1)
+	{
+		expand_arith(sb, str, *i + 2, end - *i - 4, env);
+		*i = end;
+		return ;
+	}
+	out = command_substitution(str + *i + 1, end - *i - 2, env);
+	if (out)
+		sb_append(sb, out, ft_strlen(out));
+	free(out);
+	*i = end;
+}
+
+// Expand one raw word from the lexer: variables are substituted outside
+// single quotes (with EXPAND_VARS) and the quote characters themselves
+// are removed. With EXPAND_PATTERN, quoted text is escaped so that it
+// matches literally, and with EXPAND_SPLIT everything but unquoted
+// expansions has its IFS characters escaped. *quoted is set when the
+// word contained any quotes, so that callers can tell `""` (an empty argument) from an expansion
+// that produced nothing.
+static char	*expand_raw(char *str, t_env *env, int exit_status,
+		int mode, int *quoted)
+{
+	t_strbuf	sb;
+	char		quote;
+	int		i;
+
+	ft_bzero(&sb, sizeof(sb));
+	if (!sb_append(&sb, "", 0))
 		return (NULL);
+	sb.fields = (mode & EXPAND_SPLIT) != 0;
+	*quoted = 0;
+	quote = 0;
 	i = 0;
 	while (str[i])
 	{
-		if (str[i] == '$')
+		sb.escape = 0;
+		if ((mode & (EXPAND_PATTERN | EXPAND_GLOB)) && quote)
+			sb.escape = ESCAPE_META;
+		else if (mode & EXPAND_GLOB)
+			sb.escape = ESCAPE_BACKSLASH;
+		if ((mode & EXPAND_SPLIT) && (quote || str[i] != '$'))
+			sb.escape |= ESCAPE_IFS;
+		if ((str[i] == '\'' || str[i] == '"') && (!quote || quote == str[i]))
 		{
+			quote = quote ? 0 : str[i];
+			*quoted = 1;
 			i++;
-			if (str[i] == '?')
-			{
-				char *exit_str = ft_itoa(exit_status);
-				temp_result = ft_strjoin(result, exit_str);
-				free(result);
-				free(exit_str);
-				result = temp_result;
-				i++;
-			}
-			else if (ft_isalpha(str[i]) || str[i] == '_')
-			{
-				start = i;
-				while (str[i] && (ft_isalnum(str[i]) || str[i] == '_'))
-					i++;
-				var_name = ft_substr(str, start, i - start);
-				var_value = get_env_value(env, var_name);
-				if (var_value)
-				{
-					temp_result = ft_strjoin(result, var_value);
-					free(result);
-					result = temp_result;
-				}
-				free(var_name);
-			}
-			else if (str[i] == '\0')
-			{
-				// '$' at end of string
-				temp_result = ft_strjoin(result, "$");
-				free(result);
-				result = temp_result;
-			}
-			else
-			{
-				// '$' followed by invalid character
-				char dollar_and_char[3];
-				dollar_and_char[0] = '$';
-				dollar_and_char[1] = str[i];
-				dollar_and_char[2] = '\0';
-				temp_result = ft_strjoin(result, dollar_and_char);
-				free(result);
-				result = temp_result;
-				i++;
-			}
 		}
-		else
+		else if (str[i] == '$' && (mode & EXPAND_VARS) && quote != '\'')
 		{
-			char c_str[2];
-			c_str[0] = str[i];
-			c_str[1] = '\0';
-			temp_result = ft_strjoin(result, c_str);
-			free(result);
-			result = temp_result;
 			i++;
+			// $"..." and $'...' drop the dollar outside of quotes
+			if (!quote && (str[i] == '\'' || str[i] == '"'))
+				continue ;
+			if (str[i] == '(')
+				expand_command_sub(&sb, str, &i, env);
+			else
+				expand_variable(&sb, str, &i, env, exit_status);
 		}
+		else if ((str[i] == '<' || str[i] == '>') && str[i + 1] == '('
+			&& (mode & EXPAND_VARS) && !quote)
+			expand_process_sub(&sb, str, &i, env);
+		else
+			append_literal(&sb, str, &i);
+	}
+	sb.escape = 0;
+	if (sb.failed)
+	{
+		free(sb.data);
+		return (NULL);
 	}
-	return (result);
+	return (sb.data);
+}
+
+char	*expand_word(char *word, t_env *env, int exit_status)
+{
+	int	quoted;
+
+	if (!word)
+		return (NULL);
+	return (expand_raw(word, env, exit_status, EXPAND_VARS, &quoted));
+}
+
+// Like expand_word, for a word used as a pattern: `"*"` stays a star
+char	*expand_pattern(char *word, t_env *env, int exit_status)
+{
+	int	quoted;
+
+	if (!word)
+		return (NULL);
+	return (expand_raw(word, env, exit_status, EXPAND_VARS | EXPAND_PATTERN,
+			&quoted));
 }
 
-char	*expand_string(char *str, t_env *env, int exit_status, int quote_type)
+char	*remove_quotes(char *word)
 {
-	char	*result;
+	int	quoted;
 
-	if (!str)
+	if (!word)
 		return (NULL);
-	
-	// Handle expansion based on quote type
-	if (quote_type == 1)
+	return (expand_raw(word, NULL, 0, 0, &quoted));
+}
+
+// One word of a command after expansion: its value, the words it
+// became (glob matches, or the expansions of a brace word), or a brace
+// tree whose words go straight into argv
+typedef struct s_field
+{
+	char	*value;
+	char	**matches;
+	t_brace	*brace;
+	size_t	count;	// argv entries the word becomes (at most, for brace)
+}	t_field;
+
+// What every word of one argv shares while it is expanded
+typedef struct s_argctx
+{
+	t_env		*env;
+	int		exit_status;
+	t_glob_dir	*cache;	// directories read so far
+	int		declare;	// `export`: NAME=value words are not split
+}	t_argctx;
+
+// Whether raw has an unquoted `$` or a "$@": only those words can
+// split. `$(` inside double quotes is skipped the way expand_raw skips
+// it.
+static int	may_split(const char *raw)
+{
+	char	quote;
+	int	i;
+
+	quote = 0;
+	i = 0;
+	while (raw[i])
 	{
-		// Single quotes: no expansion at all
-		result = ft_strdup(str);
+		if ((raw[i] == '\'' || raw[i] == '"') && (!quote || quote == raw[i]))
+			quote = quote ? 0 : raw[i];
+		else if (raw[i] == '$' && (!quote || (quote == '"'
+					&& (raw[i + 1] == '@' || ft_strncmp(raw + i + 1, "{@", 2) == 0))))
+			return (1);
+		else if (raw[i] == '$' && quote == '"' && raw[i + 1] == '('
+			&& match_paren(raw, i + 1) != -1)
+			i = match_paren(raw, i + 1) - 1;
+		i++;
 	}
-	else if (quote_type == 2 || quote_type == 0)
+	return (0);
+}
+
+// NAME=value
+static int	is_assignment(const char *raw)
+{
+	int	i;
+
+	if (!ft_isalpha(raw[0]) && raw[0] != '_')
+		return (0);
+	i = 1;
+	while (ft_isalnum(raw[i]) || raw[i] == '_')
+		i++;
+	return (raw[i] == '=');
+}
+
+// "$@" alone with no positional parameters, which is no word at all
+static int	is_empty_at(const char *raw)
+{
+	if (get_shell()->params.argc != 0)
+		return (0);
+	return (ft_strncmp(raw, "\"$@\"", 5) == 0
+		|| ft_strncmp(raw, "\"${@}\"", 7) == 0);
+}
+
+// Words of a field as an array, whatever form the field is in
+static char	**field_words(t_field *f)
+{
+	if (f->matches)
+		return (f->matches);
+	return (&f->value);
+}
+
+static int	append_words(t_field *f, char **words, size_t n, size_t *cap)
+{
+	char	**grown;
+
+	while (f->count + n > *cap)
 	{
-		// Double quotes or no quotes: expand variables
-		result = expand_variable(str, env, exit_status);
+		*cap = *cap ? *cap * 2 : 16;
+		grown = malloc(sizeof(char *) * *cap);
+		if (!grown)
+			return (0);
+		if (f->matches)
+			ft_memcpy(grown, f->matches, sizeof(char *) * f->count);
+		free(f->matches);
+		f->matches = grown;
 	}
-	else
+	ft_memcpy(f->matches + f->count, words, sizeof(char *) * n);
+	f->count += n;
+	return (1);
+}
+
+// A word that split into several fields: each field is globbed on
+// its own and the results gathered in f->matches
+static int	split_fields(t_field *f, char *word, char *cursor, t_argctx *ctx)
+{
+	char	**matches;
+	size_t	cap;
+	size_t	n;
+	int	ok;
+
+	ok = 1;
+	cap = 0;
+	while (ok && word)
 	{
-		// Mixed quotes: treat as no quotes (expand variables)
-		result = expand_variable(str, env, exit_status);
+		matches = NULL;
+		if (glob_has_meta(word))
+			matches = glob_expand(word, &ctx->cache, &n);
+		if (!matches)
+		{
+			glob_unescape(word);
+			word = ft_strdup(word);
+			matches = &word;
+			n = 1;
+			ok = (word != NULL);
+		}
+		if (ok && !append_words(f, matches, n, &cap))
+		{
+			while (n > 0)
+				free(matches[--n]);
+			ok = 0;
+		}
+		if (matches != &word)
+			free(matches);
+		word = ifs_field(&cursor);
 	}
-	
-	return (result);
+	free(f->value);
+	f->value = NULL;
+	return (ok);
 }
 
-void	expand_tokens(t_token *tokens, t_env *env, int exit_status)
+// Expand, split and glob one word. A word with a single field keeps
+// its buffer: the field is moved to the front of it.
+static int	expand_single(t_field *f, char *raw, t_argctx *ctx)
 {
-	t_token	*current;
-	char	*expanded;
+	char	*cursor;
+	char	*word;
+	int	quoted;
+	int	mode;
 
-	current = tokens;
-	while (current)
+	f->matches = NULL;
+	f->brace = NULL;
+	f->count = 0;
+	mode = EXPAND_VARS | EXPAND_GLOB | EXPAND_SPLIT;
+	if ((ctx->declare && is_assignment(raw)) || !may_split(raw))
+		mode = EXPAND_VARS | EXPAND_GLOB;
+	f->value = expand_raw(raw, ctx->env, ctx->exit_status, mode, &quoted);
+	if (!f->value)
+		return (0);
+	if (is_empty_at(raw))
+		quoted = 0;
+	word = f->value;
+	cursor = "";
+	if (mode & EXPAND_SPLIT)
+	{
+		cursor = ifs_trim(f->value);
+		word = ifs_field(&cursor);
+	}
+	if (!word || (!(mode & EXPAND_SPLIT) && !*word))
 	{
-		if (current->type == TOKEN_WORD)
+		f->value[0] = '\0';
+		f->count = quoted;
+		return (1);
+	}
+	if (*cursor)
+		return (split_fields(f, word, cursor, ctx));
+	if (word != f->value)
+		ft_memmove(f->value, word, ft_strlen(word) + 1);
+	if (glob_has_meta(f->value))
+		f->matches = glob_expand(f->value, &ctx->cache, &f->count);
+	if (!f->matches)
+	{
+		glob_unescape(f->value);
+		f->count = 1;
+	}
+	return (1);
+}
+
+// Free whatever a field still owns
+static void	free_field(t_field *f)
+{
+	size_t	k;
+
+	k = 0;
+	while (f->matches && k < f->count)
+		free(f->matches[k++]);
+	free(f->matches);
+	free(f->value);
+	brace_free(f->brace);
+	f->matches = NULL;
+	f->value = NULL;
+	f->brace = NULL;
+	f->count = 0;
+}
+
+// A brace word that still needs expanding: each of its words goes
+// through expand_single and the results are gathered in f->matches
+static int	expand_braced(t_field *f, t_brace *tree, t_argctx *ctx)
+{
+	t_field	sub;
+	char	**raw;
+	size_t	cap;
+	size_t	n;
+	size_t	i;
+	int	ok;
+
+	raw = malloc(sizeof(char *) * (tree->count + 1));
+	n = 0;
+	if (raw)
+		n = brace_fill(tree, raw);
+	brace_free(tree);
+	ok = (raw != NULL);
+	cap = 0;
+	i = 0;
+	while (ok && i < n)
+	{
+		ok = expand_single(&sub, raw[i++], ctx);
+		if (ok && append_words(f, field_words(&sub), sub.count, &cap))
 		{
-			expanded = expand_string(current->value, env, exit_status, current->quote_type);
-			if (expanded)
-			{
-				free(current->value);
-				current->value = expanded;
-			}
+			if (sub.matches || !sub.count)
+				free(sub.value);
+			free(sub.matches);
+		}
+		else if (ok)
+		{
+			free_field(&sub);
+			ok = 0;
 		}
-		current = current->next;
 	}
+	while (n > 0)
+		free(raw[--n]);
+	free(raw);
+	if (!ok)
+		free_field(f);
+	return (ok);
 }
 
-void	compact_empty_tokens(t_token **tokens)
+// Brace words made of plain text expand to exactly their brace words
+static int	is_plain(const char *raw)
 {
-	t_token *curr;
-	t_token *prev;
+	while (*raw)
+	{
+		if (ft_strchr("$'\"\\*?[<>", *raw))
+			return (0);
+		raw++;
+	}
+	return (1);
+}
 
-	if (!tokens || !*tokens)
-		return ;
-	prev = NULL;
-	curr = *tokens;
-	while (curr)
+// Words with nothing to quote-remove, expand, split or match, such as
+// most command names and options
+static int	is_literal(const char *raw)
+{
+	while (*raw)
+	{
+		if (ft_strchr("$'\"\\*?[{~<>`", *raw))
+			return (0);
+		raw++;
+	}
+	return (1);
+}
+
+static int	expand_field(t_field *f, char *raw, t_argctx *ctx)
+{
+	t_brace	*tree;
+	size_t	n;
+
+	f->value = NULL;
+	f->matches = NULL;
+	f->brace = NULL;
+	f->count = 0;
+	if (is_literal(raw))
 	{
-		if (curr->type == TOKEN_WORD && curr->value && curr->value[0] == '\0')
+		// Nothing to expand: the word is its own field
+		f->value = ft_strdup(raw);
+		f->count = 1;
+		return (f->value != NULL);
+	}
+	if (!brace_parse(raw, &tree, &n))
+		return (0);
+	if (tree && is_plain(raw))
+	{
+		f->brace = tree;
+		f->count = n;
+		return (1);
+	}
+	if (tree)
+		return (expand_braced(f, tree, ctx));
+	return (expand_single(f, raw, ctx));
+}
+
+// Move the fields into argv, or free them all when argv is NULL
+static void	collect_fields(char **argv, t_field *fields, int n)
+{
+	size_t	at;
+	int	i;
+
+	at = 0;
+	i = -1;
+	while (++i < n)
+	{
+		if (!argv)
+			free_field(&fields[i]);
+		else if (fields[i].brace)
 		{
-			// remove this token
-			t_token *to_free = curr;
-			if (prev)
-				prev->next = curr->next;
-			else
-				*tokens = curr->next;
-			curr = curr->next;
-			free(to_free->value);
-			free(to_free);
-			continue;
+			at += brace_fill(fields[i].brace, argv + at);
+			brace_free(fields[i].brace);
 		}
-		prev = curr;
-		curr = curr->next;
+		else if (fields[i].matches)
+		{
+			ft_memcpy(argv + at, fields[i].matches,
+				sizeof(char *) * fields[i].count);
+			at += fields[i].count;
+			free(fields[i].matches);
+			free(fields[i].value);
+		}
+		else if (fields[i].count)
+			argv[at++] = fields[i].value;
+		else
+			free(fields[i].value);
 	}
+	if (argv)
+		argv[at] = NULL;
+}
+
+// Build the final argv for a command. Brace words are expanded first,
+// unquoted expansions are split on IFS, unquoted words that expand to
+// nothing are dropped and patterns are replaced by the sorted paths they match.
+// Every word is expanded before argv is allocated, once, at its final
+// size; plain brace words are generated straight into it.
+char	**expand_args(char **args, t_env *env, int exit_status)
+{
+	t_field		*fields;
+	t_argctx	ctx;
+	char		**argv;
+	size_t		total;
+	int		count;
+	int		i;
+
+	count = 0;
+	while (args && args[count])
+		count++;
+	fields = malloc(sizeof(t_field) * (count + 1));
+	if (!fields)
+		return (NULL);
+	ctx.env = env;
+	ctx.exit_status = exit_status;
+	ctx.cache = NULL;
+	ctx.declare = (count > 0 && ft_strncmp(args[0], "export", 7) == 0);
+	i = 0;
+	while (i < count && !ft_strchr(args[i], '$'))
+		i++;
+	if (i < count)
+		ifs_load(env); // only words with a `$` can split
+	total = 0;
+	i = 0;
+	while (i < count && expand_field(&fields[i], args[i], &ctx))
+		total += fields[i++].count;
+	glob_free_cache(ctx.cache);
+	argv = NULL;
+	if (i == count)
+		argv = malloc(sizeof(char *) * (total + 1));
+	collect_fields(argv, fields, i);
+	free(fields);
+	return (argv);
 }
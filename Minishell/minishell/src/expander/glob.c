@@ -0,0 +1,447 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   glob.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 17:05:12 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 17:05:14 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#define _GNU_SOURCE
+#include "expander.h"
+#include <fcntl.h>
+#include <dirent.h>
+#ifdef __linux__
+# include <sys/syscall.h>
+#endif
+
+// Pathname expansion. A pattern is matched one path component at a
+// time; every directory it needs is read once per command into a
+// t_glob_dir listing that the other words of the command reuse.
+
+#define GLOB_DENTS_BUF 65536
+
+typedef struct s_glob
+{
+	t_glob_dir	**cache;
+	char		**out;
+	size_t		count;
+	size_t		cap;
+}	t_glob;
+
+// One path component, compiled once: names must start with prefix and
+// end with suffix before the full matcher is tried. For `P*S` the
+// quick test alone decides.
+typedef struct s_glob_pat
+{
+	char	*text;
+	size_t	prefix_len;
+	char	*suffix;
+	size_t	suffix_len;
+	int	simple;
+}	t_glob_pat;
+
+#ifdef __linux__
+
+typedef struct s_dirent64
+{
+	unsigned long long	d_ino;
+	long long		d_off;
+	unsigned short		d_reclen;
+	unsigned char		d_type;
+	char			d_name[];
+}	t_dirent64;
+#endif
+
+// Whether word (as produced by EXPAND_GLOB) has an unescaped `*`, `?`
+// or a `[` that is closed later on
+int	glob_has_meta(const char *word)
+{
+	const char	*close;
+
+	while (*word)
+	{
+		if (*word == '\\' && word[1])
+			word++;
+		else if (*word == '*' || *word == '?')
+			return (1);
+		else if (*word == '[' && word[1])
+		{
+			close = ft_strchr(word + 2, ']');
+			if (close)
+				return (1);
+		}
+		word++;
+	}
+	return (0);
+}
+
+// Drop the escaping backslashes, in place
+void	glob_unescape(char *word)
+{
+	char	*out;
+
+	out = word;
+	while (*word)
+	{
+		if (*word == '\\' && word[1])
+			word++;
+		*out++ = *word++;
+	}
+	*out = '\0';
+}
+
+// Record one entry; `.` and `..` are never matched
+static int	add_entry(t_glob_dir *dir, const char *name, unsigned char type)
+{
+	t_glob_entry	*grown;
+	size_t		cap;
+
+	if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+		return (1);
+	if (dir->count == dir->cap)
+	{
+		cap = dir->cap ? dir->cap * 2 : 256;
+		grown = malloc(sizeof(t_glob_entry) * cap);
+		if (!grown)
+			return (0);
+		if (dir->entries)
+			ft_memcpy(grown, dir->entries, sizeof(t_glob_entry) * dir->count);
+		free(dir->entries);
+		dir->entries = grown;
+		dir->cap = cap;
+	}
+	dir->entries[dir->count].name = name;
+	dir->entries[dir->count++].type = type;
+	return (1);
+}
+
+// A new buffer chained in front of dir->chunks; its first bytes link
+// to the previous one
+static char	*new_chunk(t_glob_dir *dir, size_t size)
+{
+	char	*chunk;
+
+	chunk = malloc(sizeof(char *) + size);
+	if (!chunk)
+		return (NULL);
+	*(char **)chunk = dir->chunks;
+	dir->chunks = chunk;
+	return (chunk + sizeof(char *));
+}
+
+#ifdef __linux__
+
+// Read the whole directory with large getdents64 batches. The records
+// stay in the buffers the kernel filled and the listing points at
+// their names, so nothing is copied per entry.
+static int	read_entries(int fd, t_glob_dir *dir)
+{
+	char		*buf;
+	long		n;
+	long		at;
+	t_dirent64	*ent;
+
+	n = 1;
+	while (n > 0)
+	{
+		buf = new_chunk(dir, GLOB_DENTS_BUF);
+		if (!buf)
+			return (0);
+		n = syscall(SYS_getdents64, fd, buf, GLOB_DENTS_BUF);
+		at = 0;
+		while (at < n)
+		{
+			ent = (t_dirent64 *)(buf + at);
+			if (!add_entry(dir, ent->d_name, ent->d_type))
+				return (0);
+			at += ent->d_reclen;
+		}
+	}
+	return (n == 0);
+}
+#else
+
+static int	read_entries(int fd, t_glob_dir *dir)
+{
+	DIR		*d;
+	struct dirent	*ent;
+	char		*name;
+	int		ok;
+
+	d = fdopendir(fd);
+	if (!d)
+		return (0);
+	ok = 1;
+	ent = readdir(d);
+	while (ok && ent)
+	{
+		name = new_chunk(dir, ft_strlen(ent->d_name) + 1);
+		if (name)
+			ft_strlcpy(name, ent->d_name, ft_strlen(ent->d_name) + 1);
+		ok = name && add_entry(dir, name, ent->d_type);
+		ent = readdir(d);
+	}
+	closedir(d);
+	return (ok);
+}
+#endif
+
+// The listing of path, read on first use. An unreadable directory is
+// cached as empty.
+static t_glob_dir	*list_dir(t_glob *g, const char *path)
+{
+	t_glob_dir	*dir;
+	int		fd;
+
+	dir = *g->cache;
+	while (dir && ft_strncmp(dir->path, path, ft_strlen(path) + 1) != 0)
+		dir = dir->next;
+	if (dir)
+		return (dir);
+	dir = ft_calloc(1, sizeof(t_glob_dir));
+	if (!dir)
+		return (NULL);
+	dir->path = ft_strdup(path);
+	fd = open(path[0] ? path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd != -1)
+	{
+		if (!read_entries(fd, dir))
+			dir->count = 0;
+#ifdef __linux__
+		close(fd);
+#endif
+	}
+	dir->next = *g->cache;
+	*g->cache = dir;
+	return (dir);
+}
+
+void	glob_free_cache(t_glob_dir *cache)
+{
+	t_glob_dir	*next;
+	char		*chunk;
+
+	while (cache)
+	{
+		next = cache->next;
+		while (cache->chunks)
+		{
+			chunk = cache->chunks;
+			cache->chunks = *(char **)chunk;
+			free(chunk);
+		}
+		free(cache->path);
+		free(cache->entries);
+		free(cache);
+		cache = next;
+	}
+}
+
+static void	compile_pat(t_glob_pat *pat, char *text)
+{
+	char	*star;
+
+	pat->text = text;
+	pat->prefix_len = pattern_literal_len(text);
+	star = ft_strrchr(text, '*');
+	pat->suffix = "";
+	pat->simple = 0;
+	if (star && star[1 + pattern_literal_len(star + 1)] == '\0')
+	{
+		pat->suffix = star + 1;
+		pat->simple = (text + pat->prefix_len == star);
+	}
+	pat->suffix_len = ft_strlen(pat->suffix);
+}
+
+static int	pat_matches(t_glob_pat *pat, const char *name)
+{
+	size_t	len;
+
+	if (name[0] == '.' && pat->text[0] != '.')
+		return (0);
+	len = ft_strlen(name);
+	if (len < pat->prefix_len + pat->suffix_len
+		|| ft_memcmp(name, pat->text, pat->prefix_len) != 0
+		|| ft_memcmp(name + len - pat->suffix_len, pat->suffix,
+			pat->suffix_len) != 0)
+		return (0);
+	return (pat->simple || pattern_match(pat->text, name, len));
+}
+
+static int	add_match(t_glob *g, char *path)
+{
+	char	**grown;
+
+	if (!path)
+		return (0);
+	if (g->count == g->cap)
+	{
+		g->cap = g->cap ? g->cap * 2 : 16;
+		grown = malloc(sizeof(char *) * g->cap);
+		if (!grown)
+		{
+			free(path);
+			return (0);
+		}
+		if (g->out)
+			ft_memcpy(grown, g->out, sizeof(char *) * g->count);
+		free(g->out);
+		g->out = grown;
+	}
+	g->out[g->count++] = path;
+	return (1);
+}
+
+static char	*join_path(const char *prefix, const char *name, size_t len)
+{
+	t_strbuf	sb;
+
+	ft_bzero(&sb, sizeof(sb));
+	if (!sb_append(&sb, prefix, ft_strlen(prefix))
+		|| !sb_append(&sb, name, len))
+	{
+		free(sb.data);
+		return (NULL);
+	}
+	return (sb.data);
+}
+
+static int	is_directory(const char *path, unsigned char type)
+{
+	struct stat	st;
+
+	if (type == DT_DIR)
+		return (1);
+	if (type != DT_LNK && type != DT_UNKNOWN)
+		return (0);
+	return (stat(path, &st) == 0 && S_ISDIR(st.st_mode));
+}
+
+static int	walk(t_glob *g, const char *prefix, const char *rest);
+
+// Go on from one matched name: sep is the run of slashes after the
+// component in the pattern and rest what follows it
+static int	follow_match(t_glob *g, char *path, unsigned char type,
+		const char *sep)
+{
+	size_t	seplen;
+	char	*full;
+	int	ok;
+
+	if (!path)
+		return (0);
+	seplen = 0;
+	while (sep[seplen] == '/')
+		seplen++;
+	if (!seplen)
+		return (add_match(g, path));
+	full = NULL;
+	if (is_directory(path, type))
+		full = join_path(path, "/", 1);
+	free(path);
+	if (full && !sep[seplen])
+		return (add_match(g, full));
+	ok = 1;
+	if (full)
+		ok = walk(g, full, sep + seplen);
+	free(full);
+	return (ok);
+}
+
+// Match the component pat against every entry of prefix's listing
+static int	walk_dir(t_glob *g, const char *prefix, t_glob_pat *pat,
+		const char *sep)
+{
+	t_glob_dir	*dir;
+	const char	*name;
+	size_t		i;
+	int		ok;
+
+	dir = list_dir(g, prefix);
+	ok = (dir != NULL);
+	i = 0;
+	while (ok && i < dir->count)
+	{
+		name = dir->entries[i].name;
+		if (pat_matches(pat, name))
+			ok = follow_match(g, join_path(prefix, name, ft_strlen(name)),
+					dir->entries[i].type, sep);
+		i++;
+	}
+	return (ok);
+}
+
+// prefix is what has been matched so far (empty or ending in '/'),
+// rest the pattern still to match. Literal components are only
+// checked for existence at the end.
+static int	walk(t_glob *g, const char *prefix, const char *rest)
+{
+	t_glob_pat	pat;
+	struct stat	st;
+	char		*comp;
+	char		*next;
+	size_t		len;
+	int		ok;
+
+	len = 0;
+	while (rest[len] && rest[len] != '/')
+		len++;
+	comp = ft_substr(rest, 0, len);
+	if (!comp)
+		return (0);
+	if (glob_has_meta(comp))
+	{
+		compile_pat(&pat, comp);
+		ok = walk_dir(g, prefix, &pat, rest + len);
+		free(comp);
+		return (ok);
+	}
+	free(comp);
+	while (rest[len] == '/')
+		len++;
+	next = join_path(prefix, rest, len);
+	if (!next)
+		return (0);
+	glob_unescape(next + ft_strlen(prefix));
+	if (rest[len])
+		ok = walk(g, next, rest + len);
+	else if (lstat(next, &st) == 0)
+		return (add_match(g, next));
+	else
+		ok = 1;
+	free(next);
+	return (ok);
+}
+
+static int	compare_paths(const void *a, const void *b)
+{
+	return (ft_strncmp(*(char *const *)a, *(char *const *)b, (size_t)-1));
+}
+
+// Paths matching pattern, sorted, or NULL when there are none (the
+// caller then keeps the word). *count is set to the number of matches.
+char	**glob_expand(const char *pattern, t_glob_dir **cache, size_t *count)
+{
+	t_glob	g;
+
+	g.cache = cache;
+	g.out = NULL;
+	g.count = 0;
+	g.cap = 0;
+	if (!walk(&g, "", pattern) || g.count == 0)
+	{
+		while (g.count > 0)
+			free(g.out[--g.count]);
+		free(g.out);
+		*count = 0;
+		return (NULL);
+	}
+	qsort(g.out, g.count, sizeof(char *), compare_paths);
+	*count = g.count;
+	return (g.out);
+}
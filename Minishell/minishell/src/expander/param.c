@@ -0,0 +1,499 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   param.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:20:47 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 16:20:49 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "expander.h"
+#include "arith.h"
+
+// ${name} and ${#name}, plus the operators on the value of name:
+//   ${name:-word} ${name:=word} ${name:+word} ${name:?word}, and the
+//   same without ':' (which only test for unset, not for empty)
+//   ${name#pat} ${name##pat} ${name%pat} ${name%%pat}
+//   ${name/old/new} ${name//old/new} ${name/#old/new} ${name/%old/new}
+//   ${name:offset} ${name:offset:length}
+// Operator words are only expanded when the operator needs them.
+
+typedef struct s_param
+{
+	t_strbuf	*sb;
+	const char	*str;
+	t_env		*env;
+	int		status;
+	char		*name;
+	char		*value;	// NULL when unset
+	int		word;	// start of the operator's word in str
+	int		end;	// index of the closing brace
+}	t_param;
+
+static void	bad_substitution(t_param *pm, int dollar)
+{
+	fprintf(stderr, "minishell: %.*s: bad substitution\n",
+		pm->end + 1 - dollar, pm->str + dollar);
+	pm->sb->failed = 1;
+}
+
+// Index of the first c in str[start..end) outside quotes, backslash
+// escapes and nested substitutions, or end
+static int	find_unquoted(const char *str, int start, int end, char c)
+{
+	char	quote;
+
+	quote = 0;
+	while (start < end)
+	{
+		if (quote && str[start] == quote)
+			quote = 0;
+		else if (!quote && (str[start] == '\'' || str[start] == '"'))
+			quote = str[start];
+		else if (!quote && str[start] == '\\' && start + 1 < end)
+			start++;
+		else if (!quote && str[start] == c)
+			return (start);
+		else if (str[start] == '$' && quote != '\''
+			&& (str[start + 1] == '(' || str[start + 1] == '{'))
+		{
+			start = match_paren(str, start + 1);
+			if (start == -1)
+				return (end);
+			continue ;
+		}
+		start++;
+	}
+	return (end);
+}
+
+// Expand the word str[start..end); as a pattern, quoted characters are
+// escaped so that they match literally
+static char	*operand(t_param *pm, int start, int end, int pattern)
+{
+	char	*raw;
+	char	*out;
+
+	raw = ft_substr(pm->str, start, end - start);
+	out = NULL;
+	if (raw && pattern)
+		out = expand_pattern(raw, pm->env, pm->status);
+	else if (raw)
+		out = expand_word(raw, pm->env, pm->status);
+	free(raw);
+	if (!out)
+		pm->sb->failed = 1;
+	return (out);
+}
+
+static int	arith_operand(t_param *pm, int start, int end, long long *out)
+{
+	char	*text;
+	int	ok;
+
+	text = operand(pm, start, end, 0);
+	ok = (text && arith_eval(text, pm->env, out) == 0);
+	free(text);
+	if (!ok)
+		pm->sb->failed = 1;
+	return (ok);
+}
+
+static void	append_value(t_param *pm)
+{
+	if (pm->value)
+		sb_append(pm->sb, pm->value, ft_strlen(pm->value));
+}
+
+// :- := :+ :? and their forms without ':'
+static void	apply_default(t_param *pm, char op, int colon)
+{
+	char	*word;
+	int	missing;
+
+	missing = (!pm->value || (colon && !pm->value[0]));
+	if (op == '+' ? missing : !missing)
+	{
+		if (op != '+')
+			append_value(pm);
+		return ;
+	}
+	word = operand(pm, pm->word, pm->end, 0);
+	if (!word)
+		return ;
+	if (op == '?')
+	{
+		fprintf(stderr, "minishell: %s: %s\n", pm->name,
+			word[0] ? word : "parameter null or not set");
+		pm->sb->failed = 1;
+	}
+	else if (op == '=' && !ft_isalpha(pm->name[0]) && pm->name[0] != '_')
+	{
+		fprintf(stderr, "minishell: $%s: cannot assign in this way\n",
+			pm->name);
+		pm->sb->failed = 1;
+	}
+	else
+	{
+		if (op == '=')
+			set_env_value(&pm->env, pm->name, word);
+		sb_append(pm->sb, word, ft_strlen(word));
+	}
+	free(word);
+}
+
+// `*L` and `L*` with L literal: one linear search instead of trying
+// every prefix or suffix. Returns -1 for other patterns.
+static long	trim_star_literal(const char *pat, const char *v, size_t n,
+		int suffix, int longest)
+{
+	size_t	*fail;
+	size_t	m;
+	long	at;
+	int	lead;
+
+	lead = (pat[0] == '*');
+	m = pattern_literal_len(pat + lead);
+	if (pat[lead + m] != (lead ? '\0' : '*') || (!lead && pat[m + 1]))
+		return (-1);
+	if (n < m || lead == suffix)
+	{
+		// #L* needs v to start with L, %*L needs it to end with L
+		if (n >= m && ft_memcmp(suffix ? v + n - m : v, pat + lead, m) == 0)
+			return (longest ? (long)n : (long)m);
+		return (0);
+	}
+	fail = kmp_table(pat + lead, m);
+	if (!fail)
+		return (0);
+	// #*L ends after the first or last L, %L* starts at the last or first
+	at = kmp_find(v, n, pat + lead, m, fail, suffix ? !longest : longest);
+	free(fail);
+	if (at == -1)
+		return (0);
+	return (suffix ? (long)n - at : at + (long)m);
+}
+
+// Bytes that # ## (prefix) or % %% (suffix) remove from v[0..n)
+static size_t	trim_length(const char *pat, const char *v, size_t n,
+		int suffix, int longest)
+{
+	long	k;
+	long	step;
+	size_t	m;
+
+	m = pattern_literal_len(pat);
+	if (pat[m] == '\0')
+	{
+		if (n >= m && ft_memcmp(suffix ? v + n - m : v, pat, m) == 0)
+			return (m);
+		return (0);
+	}
+	k = trim_star_literal(pat, v, n, suffix, longest);
+	if (k != -1)
+		return (k);
+	k = longest ? (long)n : 0;
+	step = longest ? -1 : 1;
+	while (k >= 0 && k <= (long)n)
+	{
+		if (pattern_match(pat, suffix ? v + n - k : v, k))
+			return (k);
+		k += step;
+	}
+	return (0);
+}
+
+static void	apply_trim(t_param *pm, int suffix, int longest)
+{
+	char	*pat;
+	size_t	n;
+	size_t	k;
+
+	if (!pm->value)
+		return ;
+	pat = operand(pm, pm->word, pm->end, 1);
+	if (!pat)
+		return ;
+	n = ft_strlen(pm->value);
+	k = trim_length(pat, pm->value, n, suffix, longest);
+	sb_append(pm->sb, pm->value + (suffix ? 0 : k), n - k);
+	free(pat);
+}
+
+// Replace literal matches, scanning v once from left to right
+static void	replace_literal(t_param *pm, const char *pat, const char *rep,
+		int all)
+{
+	size_t	*fail;
+	size_t	m;
+	size_t	n;
+	size_t	pos;
+	long	at;
+
+	m = ft_strlen(pat);
+	n = ft_strlen(pm->value);
+	fail = kmp_table(pat, m);
+	pos = 0;
+	while (fail && pos < n)
+	{
+		at = kmp_find(pm->value + pos, n - pos, pat, m, fail, 0);
+		if (at == -1)
+			break ;
+		sb_append(pm->sb, pm->value + pos, at);
+		sb_append(pm->sb, rep, ft_strlen(rep));
+		pos += at + m;
+		if (!all)
+			break ;
+	}
+	free(fail);
+	sb_append(pm->sb, pm->value + pos, n - pos);
+}
+
+// Replace the longest non-empty match at each position
+static void	replace_pattern(t_param *pm, const char *pat, const char *rep,
+		int all)
+{
+	size_t	n;
+	size_t	pos;
+	size_t	run;
+	size_t	k;
+
+	n = ft_strlen(pm->value);
+	pos = 0;
+	run = 0;
+	while (pos < n)
+	{
+		k = n - pos;
+		while (k > 0 && !pattern_match(pat, pm->value + pos, k))
+			k--;
+		if (k == 0)
+		{
+			pos++;
+			continue ;
+		}
+		sb_append(pm->sb, pm->value + run, pos - run);
+		sb_append(pm->sb, rep, ft_strlen(rep));
+		pos += k;
+		run = pos;
+		if (!all)
+			break ;
+	}
+	sb_append(pm->sb, pm->value + run, n - run);
+}
+
+// /# and /% only replace a match at the start or at the end
+static void	replace_anchored(t_param *pm, const char *pat, const char *rep,
+		int suffix)
+{
+	size_t	n;
+	size_t	k;
+
+	n = ft_strlen(pm->value);
+	k = 0;
+	if (pat[0])
+		k = trim_length(pat, pm->value, n, suffix, 1);
+	if (pat[0] && k == 0)
+	{
+		append_value(pm);
+		return ;
+	}
+	if (suffix)
+		sb_append(pm->sb, pm->value, n - k);
+	sb_append(pm->sb, rep, ft_strlen(rep));
+	if (!suffix)
+		sb_append(pm->sb, pm->value + k, n - k);
+}
+
+// mode is '/' for //old/new, '#' or '%' for anchored, 0 for /old/new
+static void	apply_replace(t_param *pm, char mode)
+{
+	char	*pat;
+	char	*rep;
+	int	slash;
+
+	if (!pm->value)
+		return ;
+	slash = find_unquoted(pm->str, pm->word, pm->end, '/');
+	pat = operand(pm, pm->word, slash, 1);
+	rep = NULL;
+	if (pat)
+		rep = operand(pm, slash + (slash < pm->end), pm->end, 0);
+	if (rep && (mode == '#' || mode == '%'))
+		replace_anchored(pm, pat, rep, mode == '%');
+	else if (rep && !pat[0])
+		append_value(pm);
+	else if (rep && pat[pattern_literal_len(pat)] == '\0')
+		replace_literal(pm, pat, rep, mode == '/');
+	else if (rep)
+		replace_pattern(pm, pat, rep, mode == '/');
+	free(pat);
+	free(rep);
+}
+
+// ${name:offset} and ${name:offset:length}; a negative offset counts
+// from the end, a negative length is where to stop counting from the end
+static void	apply_substring(t_param *pm)
+{
+	long long	off;
+	long long	len;
+	long long	n;
+	int		colon;
+
+	colon = find_unquoted(pm->str, pm->word, pm->end, ':');
+	if (!arith_operand(pm, pm->word, colon, &off))
+		return ;
+	n = 0;
+	if (pm->value)
+		n = ft_strlen(pm->value);
+	len = n;
+	if (colon < pm->end && !arith_operand(pm, colon + 1, pm->end, &len))
+		return ;
+	if (off < 0)
+		off += n;
+	if (!pm->value || off < 0 || off > n)
+		return ;
+	if (len < 0)
+		len += n - off;
+	if (len < 0)
+	{
+		fprintf(stderr, "minishell: %lld: substring expression < 0\n",
+			len - (n - off));
+		pm->sb->failed = 1;
+		return ;
+	}
+	if (len > n - off)
+		len = n - off;
+	sb_append(pm->sb, pm->value + off, len);
+}
+
+// Dispatch on the operator at str[at]
+static void	apply_operator(t_param *pm, int at, int dollar)
+{
+	const char	*s;
+
+	s = pm->str + at;
+	pm->word = at + 1;
+	if (at == pm->end)
+		append_value(pm);
+	else if (s[0] == ':' && s[1] && ft_strchr("-=+?", s[1]))
+	{
+		pm->word++;
+		apply_default(pm, s[1], 1);
+	}
+	else if (ft_strchr("-=+?", s[0]))
+		apply_default(pm, s[0], 0);
+	else if (s[0] == ':')
+		apply_substring(pm);
+	else if (s[0] == '#' || s[0] == '%')
+	{
+		pm->word += (s[1] == s[0]);
+		apply_trim(pm, s[0] == '%', s[1] == s[0]);
+	}
+	else if (s[0] == '/')
+	{
+		pm->word += (s[1] == '/' || s[1] == '#' || s[1] == '%');
+		apply_replace(pm, ft_strchr("/#%", s[1]) ? s[1] : 0);
+	}
+	else
+		bad_substitution(pm, dollar);
+}
+
+// Length of the parameter name at str[at], 0 when there is none
+static int	name_length(const char *str, int at)
+{
+	int	len;
+
+	if (str[at] == '?' || str[at] == '#' || str[at] == '@' || str[at] == '*')
+		return (1);
+	len = 0;
+	if (ft_isdigit(str[at]))
+	{
+		while (ft_isdigit(str[at + len]))
+			len++;
+		return (len);
+	}
+	if (!ft_isalpha(str[at]) && str[at] != '_')
+		return (0);
+	len = 1;
+	while (ft_isalnum(str[at + len]) || str[at + len] == '_')
+		len++;
+	return (len);
+}
+
+// Value of pm->name, NULL when unset. Numbers are formatted into buf;
+// $@ and $* are joined into *joined, which the caller frees.
+static char	*param_value(t_param *pm, char *buf, size_t size, char **joined)
+{
+	*joined = NULL;
+	if (pm->name[0] == '?')
+	{
+		snprintf(buf, size, "%d", pm->status);
+		return (buf);
+	}
+	if (ft_isdigit(pm->name[0]) || pm->name[0] == '#')
+		return (positional_value(pm->name, ft_strlen(pm->name), buf, size));
+	if (pm->name[0] == '@' || pm->name[0] == '*')
+	{
+		*joined = join_positional();
+		return (*joined);
+	}
+	return (get_env_value(pm->env, pm->name));
+}
+
+static void	append_length(t_param *pm)
+{
+	char	buf[24];
+
+	if (pm->name[0] == '@' || pm->name[0] == '*')
+		snprintf(buf, sizeof(buf), "%d", get_shell()->params.argc);
+	else
+		snprintf(buf, sizeof(buf), "%zu",
+			pm->value ? ft_strlen(pm->value) : 0);
+	sb_append(pm->sb, buf, ft_strlen(buf));
+}
+
+// ${...}: str[*i] is the '{', *i is left after the matching '}'
+void	expand_parameter(t_strbuf *sb, const char *str, int *i, t_env *env,
+		int exit_status)
+{
+	t_param	pm;
+	char	buf[24];
+	char	*joined;
+	int	counting;
+	int	len;
+
+	pm.sb = sb;
+	pm.str = str;
+	pm.env = env;
+	pm.status = exit_status;
+	pm.end = match_paren(str, *i) - 1;
+	if (pm.end < 0)
+	{
+		fprintf(stderr, "minishell: %s: bad substitution\n", str + *i - 1);
+		sb->failed = 1;
+		*i = ft_strlen(str);
+		return ;
+	}
+	counting = (str[*i + 1] == '#' && *i + 2 < pm.end);
+	len = name_length(str, *i + 1 + counting);
+	pm.name = ft_substr(str, *i + 1 + counting, len);
+	if (len == 0 || !pm.name || (counting && *i + 1 + counting + len != pm.end))
+		bad_substitution(&pm, *i - 1);
+	else if (!counting && *i + 1 + len == pm.end
+		&& (pm.name[0] == '@' || pm.name[0] == '*'))
+		append_positional(sb, pm.name[0]);
+	else
+	{
+		pm.value = param_value(&pm, buf, sizeof(buf), &joined);
+		if (counting)
+			append_length(&pm);
+		else
+			apply_operator(&pm, *i + 1 + len, *i - 1);
+		free(joined);
+	}
+	free(pm.name);
+	*i = pm.end + 1;
+}
@@ -0,0 +1,179 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pattern.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 16:12:31 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 16:12:33 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "expander.h"
+
+// Shell patterns (`*`, `?`, `[a-z]`, `[!x]`, `\c`) and literal search.
+// Patterns without any of those characters take the literal paths,
+// which are linear in the length of the subject.
+
+// Length of the literal run at the start of pat, up to the first
+// pattern character or the end
+size_t	pattern_literal_len(const char *pat)
+{
+	size_t	len;
+
+	len = 0;
+	while (pat[len] && pat[len] != '*' && pat[len] != '?'
+		&& pat[len] != '[' && pat[len] != '\\')
+		len++;
+	return (len);
+}
+
+// Match c against the bracket expression right after a '['. Returns
+// the length of the expression up to and including ']', or 0 when the
+// '[' does not start one (it is then an ordinary character).
+static int	match_class(const char *pat, unsigned char c, int *matched)
+{
+	int	negate;
+	int	i;
+
+	i = 0;
+	negate = (pat[0] == '!' || pat[0] == '^');
+	i += negate;
+	*matched = 0;
+	while (pat[i] && (pat[i] != ']' || i == negate))
+	{
+		if (pat[i + 1] == '-' && pat[i + 2] && pat[i + 2] != ']')
+		{
+			if (c >= (unsigned char)pat[i] && c <= (unsigned char)pat[i + 2])
+				*matched = 1;
+			i += 3;
+		}
+		else
+		{
+			if ((unsigned char)pat[i] == c)
+				*matched = 1;
+			i++;
+		}
+	}
+	if (pat[i] != ']')
+		return (0);
+	if (negate)
+		*matched = !*matched;
+	return (i + 1);
+}
+
+// Pattern characters consumed when the single-character pattern at pat
+// matches c, 0 when it does not
+static int	match_one(const char *pat, unsigned char c)
+{
+	int	len;
+	int	matched;
+
+	if (*pat == '?')
+		return (1);
+	if (*pat == '[')
+	{
+		len = match_class(pat + 1, c, &matched);
+		if (len)
+			return (matched ? len + 1 : 0);
+	}
+	if (*pat == '\\' && pat[1])
+		return ((unsigned char)pat[1] == c ? 2 : 0);
+	return ((unsigned char)*pat == c);
+}
+
+// Whether str[0..len) matches all of pat. Only the most recent `*` is
+// ever retried, which keeps the usual cases linear.
+int	pattern_match(const char *pat, const char *str, size_t len)
+{
+	const char	*star;
+	size_t		star_at;
+	size_t		s;
+	int		step;
+
+	star = NULL;
+	star_at = 0;
+	s = 0;
+	while (s < len || *pat)
+	{
+		if (*pat == '*')
+		{
+			star = ++pat;
+			star_at = s;
+			continue ;
+		}
+		step = 0;
+		if (s < len && *pat)
+			step = match_one(pat, (unsigned char)str[s]);
+		if (step)
+		{
+			pat += step;
+			s++;
+			continue ;
+		}
+		if (!star || star_at >= len)
+			return (0);
+		pat = star;
+		s = ++star_at;
+	}
+	return (1);
+}
+
+// Knuth-Morris-Pratt failure table: fail[k] is the length of the
+// longest proper border of needle[0..k]
+size_t	*kmp_table(const char *needle, size_t m)
+{
+	size_t	*fail;
+	size_t	k;
+	size_t	i;
+
+	fail = malloc(sizeof(size_t) * (m ? m : 1));
+	if (!fail)
+		return (NULL);
+	fail[0] = 0;
+	k = 0;
+	i = 1;
+	while (i < m)
+	{
+		while (k > 0 && needle[i] != needle[k])
+			k = fail[k - 1];
+		if (needle[i] == needle[k])
+			k++;
+		fail[i++] = k;
+	}
+	return (fail);
+}
+
+// Start of the first (or, with last, the last) occurrence of needle in
+// hay[0..n), or -1. Each character of hay is looked at a bounded number
+// of times, so this stays linear on long values.
+long	kmp_find(const char *hay, size_t n, const char *needle, size_t m,
+		const size_t *fail, int last)
+{
+	long	found;
+	size_t	k;
+	size_t	i;
+
+	if (m == 0)
+		return (last ? (long)n : 0);
+	found = -1;
+	k = 0;
+	i = 0;
+	while (i < n)
+	{
+		while (k > 0 && hay[i] != needle[k])
+			k = fail[k - 1];
+		if (hay[i] == needle[k])
+			k++;
+		if (k == m)
+		{
+			found = i + 1 - m;
+			if (!last)
+				return (found);
+			k = fail[k - 1];
+		}
+		i++;
+	}
+	return (found);
+}
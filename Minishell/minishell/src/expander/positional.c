@@ -0,0 +1,90 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   positional.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 20:16:34 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 20:16:36 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "expander.h"
+
+// $0, $1.. (${10} and up need braces), $#, $@ and $* of the function
+// call being run. At the top level there are no positional parameters.
+
+// Value of the parameter name[0..len) (digits or `#`), or NULL when it
+// is unset. Numbers are formatted into buf.
+char	*positional_value(const char *name, size_t len, char *buf, size_t size)
+{
+	t_params	*params;
+	size_t		i;
+	long		n;
+
+	params = &get_shell()->params;
+	if (name[0] == '#')
+	{
+		snprintf(buf, size, "%d", params->argc);
+		return (buf);
+	}
+	if (len == 1 && name[0] == '0')
+		return ("minishell");
+	n = 0;
+	i = 0;
+	while (i < len && n <= params->argc)
+		n = n * 10 + (name[i++] - '0');
+	if (n < 1 || n > params->argc)
+		return (NULL);
+	return (params->argv[n - 1]);
+}
+
+// $@ and $*. When the word is being split (sb->fields), each parameter
+// becomes its own field, even inside quotes for "$@", and unquoted
+// empty ones are dropped; otherwise they are joined with spaces.
+int	append_positional(t_strbuf *sb, char which)
+{
+	t_params	*params;
+	int		level;
+	int		fields;
+	int		ok;
+	int		n;
+	int		k;
+
+	params = &get_shell()->params;
+	level = sb->escape;
+	fields = sb->fields && (which == '@' || !(level & ESCAPE_IFS));
+	ok = 1;
+	n = 0;
+	k = -1;
+	while (ok && ++k < params->argc)
+	{
+		if (fields && !(level & ESCAPE_IFS) && !*params->argv[k])
+			continue ;
+		if (n++ > 0 && fields)
+		{
+			sb->escape = 0;
+			ok = sb_append(sb, FIELD_BREAK, 1);
+			sb->escape = level;
+		}
+		else if (n > 1)
+			ok = sb_append(sb, " ", 1);
+		ok = ok && sb_append(sb, params->argv[k], ft_strlen(params->argv[k]));
+	}
+	return (ok);
+}
+
+// "$*" as one string, for ${*...} and ${@...} operators
+char	*join_positional(void)
+{
+	t_strbuf	sb;
+
+	ft_bzero(&sb, sizeof(sb));
+	if (!sb_append(&sb, "", 0) || !append_positional(&sb, '*'))
+	{
+		free(sb.data);
+		return (NULL);
+	}
+	return (sb.data);
+}
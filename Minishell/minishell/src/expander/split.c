@@ -0,0 +1,124 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   split.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 18:36:10 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 18:36:12 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "expander.h"
+
+// Field splitting. Membership in IFS is one bit per byte value, built
+// only when IFS changes. Words are expanded with ESCAPE_IFS, so the
+// only unescaped IFS characters left are those that unquoted
+// expansions produced, and the word is cut at them in place.
+
+#define IFS_DEFAULT " \t\n"
+
+typedef struct s_ifs
+{
+	char			*value;	// IFS the bitmaps were built from
+	int			loaded;
+	unsigned long long	member[4];
+	unsigned long long	white[4];	// IFS white space
+}	t_ifs;
+
+static t_ifs	g_ifs;
+
+// Cursor after a FIELD_BREAK that ends the word: one more, empty field
+static char	g_trailing[2] = FIELD_BREAK;
+
+static void	set_bit(unsigned long long *map, unsigned char c)
+{
+	map[c >> 6] |= 1ULL << (c & 63);
+}
+
+static int	has_bit(const unsigned long long *map, unsigned char c)
+{
+	return ((map[c >> 6] >> (c & 63)) & 1);
+}
+
+// Rebuild the bitmaps if IFS is not what they were built from. Unset
+// IFS splits on white space; an empty one does not split at all.
+void	ifs_load(t_env *env)
+{
+	const char	*value;
+	int		i;
+
+	value = get_env_value(env, "IFS");
+	if (!value)
+		value = IFS_DEFAULT;
+	if (g_ifs.loaded && ft_strncmp(g_ifs.value, value,
+			ft_strlen(value) + 1) == 0)
+		return ;
+	free(g_ifs.value);
+	g_ifs.value = ft_strdup(value);
+	g_ifs.loaded = (g_ifs.value != NULL);
+	ft_bzero(g_ifs.member, sizeof(g_ifs.member));
+	ft_bzero(g_ifs.white, sizeof(g_ifs.white));
+	i = 0;
+	while (value[i])
+	{
+		set_bit(g_ifs.member, value[i]);
+		if (value[i] == ' ' || value[i] == '\t' || value[i] == '\n')
+			set_bit(g_ifs.white, value[i]);
+		i++;
+	}
+}
+
+int	ifs_member(char c)
+{
+	return (has_bit(g_ifs.member, c));
+}
+
+// Past the IFS white space at the start of word
+char	*ifs_trim(char *word)
+{
+	while (*word && has_bit(g_ifs.white, *word))
+		word++;
+	return (word);
+}
+
+// Next field at *cursor, terminated in place, or NULL at the end. A
+// delimiter is a run of IFS white space with at most one other IFS
+// character in it, so `a::b` has an empty field but `a  b` does not.
+// FIELD_BREAK (between the words of "$@") ends a field on its own.
+char	*ifs_field(char **cursor)
+{
+	char	*field;
+	char	*end;
+	char	*s;
+
+	s = *cursor;
+	if (s == g_trailing)
+	{
+		*cursor = "";
+		return (g_trailing + 1);
+	}
+	if (!*s)
+		return (NULL);
+	field = s;
+	while (*s && *s != FIELD_BREAK[0] && !has_bit(g_ifs.member, *s))
+		s += (*s == '\\' && s[1]) + 1;
+	end = s;
+	if (*s == FIELD_BREAK[0])
+	{
+		s = ifs_trim(s + 1);
+		if (!*s)
+			s = g_trailing;
+	}
+	else
+	{
+		while (*s && has_bit(g_ifs.white, *s))
+			s++;
+		if (*s && has_bit(g_ifs.member, *s) && !has_bit(g_ifs.white, *s))
+			s = ifs_trim(s + 1);
+	}
+	*end = '\0';
+	*cursor = s;
+	return (field);
+}
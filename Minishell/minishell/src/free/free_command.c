@@ -11,8 +11,9 @@
 /* ************************************************************************** */
 
 #include "parser.h"
+#include "vm.h"
 
-static void	free_redirs(t_redir *redirs)
+void	free_redirs(t_redir *redirs)
 {
 	t_redir	*current;
 	t_redir	*next;
@@ -22,25 +23,31 @@ static void	free_redirs(t_redir *redirs)
 	{
 		next = current->next;
 		free(current->file);
+		free(current->body);
 		free(current);
 		current = next;
 	}
 }
 
-static void	free_simple_cmd(t_simple_cmd *cmd)
+static void	free_words(char **words)
 {
 	int	i;
 
-	if (cmd->args)
+	if (!words)
+		return ;
+	i = 0;
+	while (words[i])
 	{
-		i = 0;
-		while (cmd->args[i])
-		{
-			free(cmd->args[i]);
-			i++;
-		}
-		free(cmd->args);
+		free(words[i]);
+		i++;
 	}
+	free(words);
+}
+
+static void	free_simple_cmd(t_simple_cmd *cmd)
+{
+	free_words(cmd->args);
+	free_words(cmd->assigns);
 	free_redirs(cmd->redirs);
 }
 
@@ -56,6 +63,26 @@ void	free_command(t_command *cmd)
 		free_command(cmd->data.pipe_cmd.left);
 		free_command(cmd->data.pipe_cmd.right);
 	}
+	else if (cmd->type == CMD_SUBSHELL || cmd->type == CMD_GROUP)
+	{
+		free_command(cmd->data.subshell.body);
+		free_redirs(cmd->data.subshell.redirs);
+	}
+	else if (cmd->type == CMD_LIST)
+	{
+		free_command(cmd->data.list.left);
+		free_command(cmd->data.list.right);
+	}
+	else if (cmd->type == CMD_COMPOUND)
+	{
+		vm_release(cmd->data.compound.prog);
+		free_redirs(cmd->data.compound.redirs);
+	}
+	else if (cmd->type == CMD_FUNCDEF)
+	{
+		free(cmd->data.funcdef.name);
+		free_command(cmd->data.funcdef.body);
+	}
 	
 	free(cmd);
 }
@@ -0,0 +1,106 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   complete.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 00:12:37 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 00:12:39 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "history.h"
+#include "builtins.h"
+#include "executor.h"
+
+// Tab completion. The word in command position completes to builtins
+// and to the programs of the PATH cache (pathcache.c), the same trie
+// command lookup uses; any other word, or one with a `/`, falls back
+// to readline's filename completion.
+
+typedef struct s_complete
+{
+	t_env	*env;
+	char	**programs;	// PATH matches of the word being completed
+	int	builtin;	// next builtin to try
+	int	program;	// next program to offer
+}	t_complete;
+
+static t_complete	g_complete;
+
+// Whether word, ending just before line[end], makes the next word a
+// command
+static int	opens_command(const char *line, int end)
+{
+	static const char	*words[] = {"if", "then", "else", "elif", "while",
+		"until", "do", "{", "!", "time", NULL};
+	int			start;
+	int			i;
+
+	start = end;
+	while (start > 0 && !ft_strchr(" \t\n;|&()", line[start - 1]))
+		start--;
+	i = 0;
+	while (words[i] && ((int)ft_strlen(words[i]) != end - start
+			|| ft_strncmp(line + start, words[i], end - start) != 0))
+		i++;
+	return (words[i] != NULL);
+}
+
+static int	command_position(int start)
+{
+	const char	*line;
+	int		i;
+
+	line = rl_line_buffer;
+	i = start;
+	while (i > 0 && (line[i - 1] == ' ' || line[i - 1] == '\t'))
+		i--;
+	if (i == 0 || ft_strchr(";|&(\n", line[i - 1]))
+		return (1);
+	return (opens_command(line, i));
+}
+
+// Builtins first, then programs; readline sorts them and drops the
+// names that are both
+static char	*next_match(const char *text, int state)
+{
+	const char	*name;
+
+	if (state == 0)
+	{
+		g_complete.programs = path_complete(text, g_complete.env);
+		g_complete.builtin = 0;
+		g_complete.program = 0;
+	}
+	name = builtin_name(g_complete.builtin);
+	while (name && ft_strncmp(name, text, ft_strlen(text)) != 0)
+		name = builtin_name(++g_complete.builtin);
+	if (name)
+	{
+		g_complete.builtin++;
+		return (ft_strdup(name));
+	}
+	if (g_complete.programs && g_complete.programs[g_complete.program])
+		return (g_complete.programs[g_complete.program++]);
+	free(g_complete.programs); // its strings went to readline
+	g_complete.programs = NULL;
+	return (NULL);
+}
+
+static char	**complete(const char *text, int start, int end)
+{
+	(void)end;
+	if (ft_strchr(text, '/') || !command_position(start))
+		return (NULL);
+	rl_attempted_completion_over = 1;
+	return (rl_completion_matches(text, next_match));
+}
+
+// Install the completion of an interactive shell
+void	complete_init(t_env *env)
+{
+	g_complete.env = env;
+	rl_attempted_completion_function = complete;
+}
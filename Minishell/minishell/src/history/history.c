@@ -0,0 +1,340 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   history.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:58:40 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:58:42 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "history.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+// Command history. Every accepted line is appended to the history file
+// with a single write, so nothing is lost when the shell dies and no
+// rewrite happens at exit. At startup the file is mapped and only its
+// last HISTSIZE lines are read, scanning back from the end; the offsets
+// of all its lines are indexed the first time something asks for them.
+// The entries kept are a ring of HISTSIZE lines, and readline's own list
+// is trimmed with it so it never grows past that either. HISTSIZE is
+// looked at again whenever history is used, so setting it takes effect
+// from the next line on.
+
+#define HIST_DEFAULT_SIZE 500
+#define HIST_FILE ".minishell_history"
+
+typedef struct s_history
+{
+	char		**ring;
+	int		size;	// HISTSIZE, the ring's capacity
+	int		first;	// slot of the oldest entry
+	int		count;
+	long		next;	// number of the next entry, -1 until needed
+	long		added;	// entries added while next was unknown
+	int		fd;	// the history file, opened for appending
+	const char	*map;	// the file as it was at startup
+	size_t		map_len;
+	size_t		*index;	// offset of each line of map
+	long		lines;	// lines in map, -1 until indexed
+	t_env		*env;	// where HISTSIZE is read
+}	t_history;
+
+static t_history	g_hist = {.fd = -1, .next = -1, .lines = -1};
+
+// HISTSIZE, or the default when unset or not a number
+static int	history_size(t_env *env)
+{
+	char	*value;
+	int	i;
+
+	value = get_env_value(env, "HISTSIZE");
+	if (!value)
+		return (HIST_DEFAULT_SIZE);
+	i = 0;
+	while (ft_isdigit(value[i]))
+		i++;
+	if (i == 0 || i > 9 || value[i])
+		return (HIST_DEFAULT_SIZE);
+	return (ft_atoi(value));
+}
+
+// Drop readline's oldest entries down to the ring's. Done in one move
+// once its list is twice the size: removing one entry is a memmove of
+// the whole list.
+static void	trim_readline(void)
+{
+	HIST_ENTRY	**gone;
+	int		i;
+
+	if (history_length <= g_hist.size)
+		return ;
+	gone = remove_history_range(0, history_length - g_hist.size - 1);
+	i = 0;
+	while (gone && gone[i])
+		free_history_entry(gone[i++]);
+	free(gone);
+}
+
+// Keep the newest entries in a new ring of size slots
+static void	resize(int size)
+{
+	char	**ring;
+	int	drop;
+	int	i;
+
+	ring = NULL;
+	if (size > 0)
+		ring = ft_calloc(size, sizeof(char *));
+	if (size > 0 && !ring)
+		return ;
+	drop = 0;
+	if (g_hist.count > size)
+		drop = g_hist.count - size;
+	i = 0;
+	while (i < g_hist.count)
+	{
+		if (i < drop)
+			free(g_hist.ring[(g_hist.first + i) % g_hist.size]);
+		else
+			ring[i - drop] = g_hist.ring[(g_hist.first + i) % g_hist.size];
+		i++;
+	}
+	free(g_hist.ring);
+	g_hist.ring = ring;
+	g_hist.size = size;
+	g_hist.first = 0;
+	g_hist.count -= drop;
+	trim_readline();
+}
+
+// Follow a change of HISTSIZE
+static void	sync_size(void)
+{
+	int	size;
+
+	if (!g_hist.env)
+		return ;
+	size = history_size(g_hist.env);
+	if (size != g_hist.size)
+		resize(size);
+}
+
+// Keep a copy of the n bytes at s as the newest entry
+static void	push(const char *s, size_t n)
+{
+	char	*entry;
+
+	entry = malloc(n + 1); // s may be the map, with no terminator
+	if (!entry)
+		return ;
+	ft_memcpy(entry, s, n);
+	entry[n] = '\0';
+	if (g_hist.count == g_hist.size)
+	{
+		free(g_hist.ring[g_hist.first]);
+		g_hist.first = (g_hist.first + 1) % g_hist.size;
+		g_hist.count--;
+	}
+	g_hist.ring[(g_hist.first + g_hist.count++) % g_hist.size] = entry;
+	add_history(entry);
+	if (history_length >= 2 * g_hist.size)
+		trim_readline();
+}
+
+// Offset of the newline ending the line at pos, or of the end of the map
+static size_t	line_end(size_t pos)
+{
+	const char	*nl;
+
+	nl = ft_memchr(g_hist.map + pos, '\n', g_hist.map_len - pos);
+	if (!nl)
+		return (g_hist.map_len);
+	return (nl - g_hist.map);
+}
+
+// Load the last HISTSIZE non-empty lines of the map
+static void	load_tail(void)
+{
+	const char	*map;
+	size_t		pos;
+	size_t		end;
+	int		n;
+
+	map = g_hist.map;
+	pos = g_hist.map_len;
+	n = 0;
+	while (pos > 0 && n < g_hist.size)
+	{
+		end = pos;
+		if (map[end - 1] == '\n')
+			end--;
+		pos = end;
+		while (pos > 0 && map[pos - 1] != '\n')
+			pos--;
+		n += (pos < end);
+	}
+	while (pos < g_hist.map_len)
+	{
+		end = line_end(pos);
+		if (end > pos)
+			push(map + pos, end - pos);
+		pos = end + 1;
+	}
+}
+
+static void	open_file(t_env *env)
+{
+	struct stat	st;
+	char		*home;
+	char		*path;
+
+	home = get_env_value(env, "HOME");
+	if (!home || !*home)
+		return ;
+	path = malloc(ft_strlen(home) + sizeof(HIST_FILE) + 1);
+	if (!path)
+		return ;
+	ft_strlcpy(path, home, ft_strlen(home) + 1);
+	ft_strlcat(path, "/" HIST_FILE, ft_strlen(home) + sizeof(HIST_FILE) + 1);
+	g_hist.fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+	free(path);
+	if (g_hist.fd < 0 || fstat(g_hist.fd, &st) < 0 || st.st_size == 0)
+		return ;
+	g_hist.map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, g_hist.fd, 0);
+	if (g_hist.map == MAP_FAILED)
+	{
+		g_hist.map = NULL;
+		return ;
+	}
+	g_hist.map_len = st.st_size;
+	if (g_hist.map[g_hist.map_len - 1] != '\n')
+		write(g_hist.fd, "\n", 1); // a line cut short must not absorb ours
+}
+
+// Start recording; called once by an interactive shell
+void	history_init(t_env *env)
+{
+	g_hist.env = env;
+	sync_size();
+	open_file(env);
+	if (g_hist.map)
+		load_tail();
+	rl_bind_key(CTRL('R'), history_isearch);
+}
+
+// Record line, unless it is empty or repeats the previous entry
+void	history_add(const char *line)
+{
+	char	*record;
+	size_t	len;
+
+	sync_size();
+	if (!g_hist.ring || !line[0] || (g_hist.count > 0
+			&& ft_strncmp(history_entry(g_hist.count - 1), line,
+				ft_strlen(line) + 1) == 0))
+		return ;
+	len = ft_strlen(line);
+	if (g_hist.fd >= 0)
+	{
+		record = malloc(len + 1);
+		if (record)
+		{
+			ft_memcpy(record, line, len);
+			record[len] = '\n';
+			write(g_hist.fd, record, len + 1);
+		}
+		free(record);
+	}
+	push(line, len);
+	search_add(line);
+	if (g_hist.next >= 0)
+		g_hist.next++;
+	else
+		g_hist.added++;
+}
+
+int	history_count(void)
+{
+	sync_size();
+	return (g_hist.count);
+}
+
+// Entry i of the ring, 0 being the oldest
+const char	*history_entry(int i)
+{
+	return (g_hist.ring[(g_hist.first + i) % g_hist.size]);
+}
+
+// Forget every entry; numbering starts again at 1. The file is kept.
+void	history_clear(void)
+{
+	while (g_hist.count > 0)
+	{
+		free(g_hist.ring[g_hist.first]);
+		g_hist.first = (g_hist.first + 1) % g_hist.size;
+		g_hist.count--;
+	}
+	clear_history();
+	g_hist.next = 1;
+}
+
+// Offsets of the non-empty lines of the map, built on first use
+static int	build_index(void)
+{
+	size_t	*grown;
+	size_t	cap;
+	size_t	pos;
+	size_t	end;
+
+	g_hist.lines = 0;
+	cap = 0;
+	pos = 0;
+	while (pos < g_hist.map_len)
+	{
+		end = line_end(pos);
+		if (end > pos && (size_t)g_hist.lines == cap)
+		{
+			cap = cap * 2 + 1024;
+			grown = malloc(sizeof(size_t) * cap);
+			if (grown && g_hist.index)
+				ft_memcpy(grown, g_hist.index, sizeof(size_t) * g_hist.lines);
+			free(g_hist.index);
+			g_hist.index = grown;
+			if (!grown)
+				return (0);
+		}
+		if (end > pos)
+			g_hist.index[g_hist.lines++] = pos;
+		pos = end + 1;
+	}
+	return (1);
+}
+
+// Lines of the history file as it was at startup
+long	history_file_lines(void)
+{
+	if (g_hist.lines < 0 && (!g_hist.map || !build_index()))
+		g_hist.lines = 0;
+	return (g_hist.lines);
+}
+
+// Line i of the file, not terminated; its length goes to *len
+const char	*history_file_line(long i, size_t *len)
+{
+	if (i < 0 || i >= history_file_lines())
+		return (NULL);
+	*len = line_end(g_hist.index[i]) - g_hist.index[i];
+	return (g_hist.map + g_hist.index[i]);
+}
+
+// History number of entry i of the ring
+long	history_number(int i)
+{
+	if (g_hist.next < 0)
+		g_hist.next = history_file_lines() + g_hist.added + 1;
+	return (g_hist.next - g_hist.count + i);
+}
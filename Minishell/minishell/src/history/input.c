@@ -0,0 +1,143 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   input.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:51:12 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:51:14 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "history.h"
+#include <fcntl.h>
+
+// Lines of shell input. A terminal goes through readline. Anything else
+// is read from a private duplicate of stdin, so redirections of fd 0
+// while a command runs do not move it. A file is read in blocks;
+// what was read past the current line is given back with lseek before
+// each fork, so that a program run from the script reads on from the
+// shell's position, as in bash. A pipe cannot be rewound and is read a
+// byte at a time.
+
+#define INPUT_BLOCK 65536
+
+typedef struct s_input
+{
+	char	buf[INPUT_BLOCK];
+	size_t	start;
+	size_t	end;
+	int	fd;		// the duplicate of stdin, -1 before the first read
+	int	seekable;
+}	t_input;
+
+static t_input	g_in = {.fd = -1};
+
+static int	open_input(void)
+{
+	g_in.fd = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 10);
+	if (g_in.fd < 0)
+		return (0);
+	g_in.seekable = (lseek(g_in.fd, 0, SEEK_CUR) >= 0);
+	return (1);
+}
+
+// Read the next block into the empty buffer; 0 at the end of input
+static int	fill(void)
+{
+	ssize_t	n;
+
+	if (g_in.fd < 0 && !open_input())
+		return (0);
+	g_in.start = 0;
+	g_in.end = 0;
+	n = -1;
+	while (n < 0)
+	{
+		n = read(g_in.fd, g_in.buf, g_in.seekable ? INPUT_BLOCK : 1);
+		if (n < 0 && errno != EINTR)
+			return (0);
+	}
+	g_in.end = n;
+	return (n > 0);
+}
+
+// line followed by n bytes of s, as a new string; line is freed
+static char	*append(char *line, size_t *len, const char *s, size_t n)
+{
+	char	*grown;
+
+	grown = malloc(*len + n + 1);
+	if (grown)
+	{
+		if (line)
+			ft_memcpy(grown, line, *len);
+		ft_memcpy(grown + *len, s, n);
+		*len += n;
+		grown[*len] = '\0';
+	}
+	free(line);
+	return (grown);
+}
+
+// readline only looks at rl_done, set by Ctrl-C, between polls of the
+// terminal, and it polls only when an event hook is set
+static int	no_event(void)
+{
+	return (0);
+}
+
+static char	*read_terminal(const char *prompt)
+{
+	t_shell	*shell;
+	char	*line;
+
+	shell = get_shell();
+	rl_event_hook = no_event;
+	g_sig = 0;
+	shell->reading = 1;
+	line = readline(prompt);
+	shell->reading = 0;
+	if (g_sig == SIGINT)
+		shell->last_status = 128 + SIGINT;
+	return (line);
+}
+
+// The next line without its newline, or NULL at the end of input. A
+// line ended by Ctrl-C comes back empty, with g_sig set and $? 130.
+char	*input_line(const char *prompt)
+{
+	char	*line;
+	char	*nl;
+	size_t	len;
+	size_t	n;
+
+	if (get_shell()->interactive)
+		return (read_terminal(prompt));
+	line = NULL;
+	len = 0;
+	while (g_in.start < g_in.end || fill())
+	{
+		nl = ft_memchr(g_in.buf + g_in.start, '\n', g_in.end - g_in.start);
+		n = g_in.end - g_in.start;
+		if (nl)
+			n = nl - (g_in.buf + g_in.start);
+		line = append(line, &len, g_in.buf + g_in.start, n);
+		g_in.start += n + (nl != NULL);
+		if (!line || nl)
+			return (line);
+	}
+	return (line);
+}
+
+// Give back the input read ahead, before a fork or an exit
+void	input_sync(void)
+{
+	if (g_in.fd < 0 || g_in.start == g_in.end)
+		return ;
+	if (g_in.seekable)
+		lseek(g_in.fd, -(off_t)(g_in.end - g_in.start), SEEK_CUR);
+	g_in.start = 0;
+	g_in.end = 0;
+}
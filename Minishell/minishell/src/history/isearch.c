@@ -0,0 +1,140 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   isearch.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:44:51 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:44:53 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "history.h"
+
+// Ctrl-R, in place of readline's reverse-search-history, which walks its
+// own list entry by entry and only sees the last HISTSIZE lines. Each
+// key runs one search_history over the whole history file.
+
+#define ISEARCH_MAX 256
+
+typedef struct s_isearch
+{
+	char	query[ISEARCH_MAX];
+	size_t	len;
+	long	match;	// entry shown, -1 for none
+	int	failed;	// the query as typed matches nothing older
+}	t_isearch;
+
+static void	show(t_isearch *s)
+{
+	const char	*text;
+	size_t		len;
+
+	text = "";
+	len = 0;
+	if (s->match >= 0)
+		text = history_text(s->match, &len);
+	rl_message("(%sreverse-i-search)`%s': %.*s", s->failed ? "failed " : "",
+		s->query, (int)len, text);
+}
+
+// Look for the query from the entry before `before` on
+static void	find(t_isearch *s, long before)
+{
+	long	id;
+
+	id = search_history(s->query, before);
+	s->failed = (id < 0);
+	if (id >= 0)
+		s->match = id;
+}
+
+// Ctrl-R again: the next older match that reads differently
+static void	older(t_isearch *s)
+{
+	const char	*shown;
+	const char	*text;
+	size_t		shown_len;
+	size_t		len;
+	long		id;
+
+	if (s->match < 0 || s->len == 0)
+		return ;
+	shown = history_text(s->match, &shown_len);
+	id = s->match;
+	while (1)
+	{
+		id = search_history(s->query, id);
+		if (id < 0)
+			break ;
+		text = history_text(id, &len);
+		if (len != shown_len || ft_memcmp(text, shown, len) != 0)
+			break ;
+	}
+	s->failed = (id < 0);
+	if (id >= 0)
+		s->match = id;
+}
+
+// Make the match the line being edited
+static void	take(t_isearch *s)
+{
+	const char	*text;
+	char		*line;
+	size_t		len;
+
+	text = history_text(s->match, &len);
+	line = malloc(len + 1);
+	if (!line)
+		return ;
+	ft_memcpy(line, text, len);
+	line[len] = '\0';
+	rl_replace_line(line, 0);
+	rl_point = rl_end;
+	free(line);
+}
+
+// Printable keys extend the query, Backspace shortens it, Ctrl-R goes
+// further back, Ctrl-G gives up. Any other key takes the match and is
+// then handled as usual, so Return runs it.
+int	history_isearch(int count, int key)
+{
+	t_isearch	s;
+	int		c;
+
+	(void)count;
+	(void)key;
+	ft_bzero(&s, sizeof(s));
+	s.match = -1;
+	while (1)
+	{
+		show(&s);
+		c = rl_read_key();
+		if (c == CTRL('R'))
+			older(&s);
+		else if ((c == RUBOUT || c == CTRL('H')) && s.len > 0)
+		{
+			s.query[--s.len] = '\0';
+			s.match = -1;
+			if (s.len)
+				find(&s, history_entries());
+		}
+		else if (c >= ' ' && c != RUBOUT && s.len + 1 < ISEARCH_MAX)
+		{
+			s.query[s.len++] = c;
+			find(&s, s.match < 0 ? history_entries() : s.match + 1);
+		}
+		else if (c != RUBOUT && c != CTRL('H'))
+			break ;
+	}
+	rl_clear_message();
+	if (c == CTRL('G'))
+		return (0);
+	if (s.match >= 0)
+		take(&s);
+	if (c == '\n' || c == '\r')
+		return (rl_newline(1, c));
+	rl_execute_next(c);
+	return (0);
+}
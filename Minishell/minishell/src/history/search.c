@@ -0,0 +1,344 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   search.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:31:26 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:31:28 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "history.h"
+
+// Substring search over the whole history: every line of the history
+// file plus the entries added since. Entries are numbered from 0, the
+// oldest. A trigram index, built the first time a query needs it and
+// then kept up to date by history_add, maps each three bytes to the
+// entries holding them. A query walks the lists of its trigrams back
+// from the newest entry in step, and only entries on all of them are
+// compared with the query, so the most recent match is found without
+// looking at the lines in between.
+
+#define SEARCH_MAX_GRAMS 16
+
+// Entries holding one trigram, in increasing order. They are stored as
+// the differences between neighbours, each a varint whose bytes but the
+// last have the high bit set, so the list also decodes from its end.
+typedef struct s_postings
+{
+	unsigned int	key;	// trigram + 1; 0 marks a free slot
+	long		last;	// newest entry on the list
+	unsigned char	*bytes;
+	size_t		len;
+	size_t		cap;
+}	t_postings;
+
+typedef struct s_cursor
+{
+	t_postings	*list;
+	size_t		pos;	// end of the next difference to undo
+	long		id;	// current entry, -1 past the oldest
+}	t_cursor;
+
+typedef struct s_search
+{
+	t_postings	*table;
+	size_t		slots;	// a power of two
+	size_t		used;
+	long		indexed;	// entries in the index, -1 before it is built
+	char		**added;	// entries added this session
+	long		added_count;
+	long		added_cap;
+}	t_search;
+
+static t_search	g_search = {.indexed = -1};
+
+long	history_entries(void)
+{
+	return (history_file_lines() + g_search.added_count);
+}
+
+// Text of entry id, not terminated; its length goes to *len
+const char	*history_text(long id, size_t *len)
+{
+	long	lines;
+
+	lines = history_file_lines();
+	if (id < lines)
+		return (history_file_line(id, len));
+	*len = ft_strlen(g_search.added[id - lines]);
+	return (g_search.added[id - lines]);
+}
+
+static t_postings	*lookup(unsigned int key)
+{
+	size_t	i;
+
+	i = (key * 2654435761U) & (g_search.slots - 1);
+	while (g_search.table[i].key && g_search.table[i].key != key)
+		i = (i + 1) & (g_search.slots - 1);
+	return (&g_search.table[i]);
+}
+
+// Double the table once it is half full
+static int	grow_table(void)
+{
+	t_postings	*old;
+	size_t		n;
+	size_t		i;
+
+	old = g_search.table;
+	n = g_search.slots;
+	g_search.slots = n * 2 + 4096 * (n == 0);
+	g_search.table = ft_calloc(g_search.slots, sizeof(t_postings));
+	if (!g_search.table)
+	{
+		g_search.table = old;
+		g_search.slots = n;
+		return (0);
+	}
+	i = 0;
+	while (i < n)
+	{
+		if (old[i].key)
+			*lookup(old[i].key) = old[i];
+		i++;
+	}
+	free(old);
+	return (1);
+}
+
+// Put id at the end of list, unless it is already there
+static int	post(t_postings *list, long id)
+{
+	unsigned char	*grown;
+	unsigned long	delta;
+	int		shift;
+
+	if (list->len && list->last == id)
+		return (1);
+	if (list->len + 10 > list->cap)
+	{
+		list->cap = list->cap * 2 + 16;
+		grown = malloc(list->cap);
+		if (!grown)
+			return (0);
+		if (list->bytes)
+			ft_memcpy(grown, list->bytes, list->len);
+		free(list->bytes);
+		list->bytes = grown;
+	}
+	delta = id - list->last;
+	if (list->len == 0)
+		delta = id + 1;
+	shift = 0;
+	while ((delta >> shift) >= 128)
+		shift += 7;
+	while (shift > 0)
+	{
+		list->bytes[list->len++] = ((delta >> shift) & 127) | 128;
+		shift -= 7;
+	}
+	list->bytes[list->len++] = delta & 127;
+	list->last = id;
+	return (1);
+}
+
+static int	index_entry(long id)
+{
+	const unsigned char	*s;
+	t_postings		*list;
+	unsigned int		key;
+	size_t			len;
+	size_t			i;
+
+	s = (const unsigned char *)history_text(id, &len);
+	i = 0;
+	while (i + 3 <= len)
+	{
+		if (g_search.used * 2 >= g_search.slots && !grow_table())
+			return (0);
+		key = ((unsigned int)s[i] << 16 | s[i + 1] << 8 | s[i + 2]) + 1;
+		list = lookup(key);
+		if (!list->key)
+		{
+			list->key = key;
+			g_search.used++;
+		}
+		if (!post(list, id))
+			return (0);
+		i++;
+	}
+	return (1);
+}
+
+// Index the entries not indexed yet. On failure the index is dropped
+// for good and queries fall back to a scan.
+static int	update_index(void)
+{
+	long	total;
+
+	if (g_search.indexed == -2)
+		return (0);
+	if (g_search.indexed < 0)
+		g_search.indexed = 0;
+	total = history_entries();
+	while (g_search.indexed < total)
+	{
+		if (!index_entry(g_search.indexed))
+		{
+			while (g_search.slots--)
+				free(g_search.table[g_search.slots].bytes);
+			free(g_search.table);
+			g_search.table = NULL;
+			g_search.slots = 0;
+			g_search.used = 0;
+			g_search.indexed = -2;
+			return (0);
+		}
+		g_search.indexed++;
+	}
+	return (1);
+}
+
+// Record line as the newest entry
+void	search_add(const char *line)
+{
+	char	**grown;
+
+	if (g_search.added_count == g_search.added_cap)
+	{
+		g_search.added_cap = g_search.added_cap * 2 + 64;
+		grown = malloc(sizeof(char *) * g_search.added_cap);
+		if (!grown)
+			return ;
+		if (g_search.added)
+			ft_memcpy(grown, g_search.added,
+				sizeof(char *) * g_search.added_count);
+		free(g_search.added);
+		g_search.added = grown;
+	}
+	g_search.added[g_search.added_count] = ft_strdup(line);
+	if (g_search.added[g_search.added_count])
+		g_search.added_count++;
+	if (g_search.indexed >= 0)
+		update_index();
+}
+
+// Move c back to the newest entry of its list not after target
+static void	seek(t_cursor *c, long target)
+{
+	unsigned long	delta;
+	size_t		end;
+	size_t		at;
+
+	while (c->id > target)
+	{
+		end = c->pos--;
+		while (c->pos > 0 && (c->list->bytes[c->pos - 1] & 128))
+			c->pos--;
+		delta = 0;
+		at = c->pos;
+		while (at < end)
+			delta = delta << 7 | (c->list->bytes[at++] & 127);
+		c->id -= delta;
+	}
+}
+
+// Whether entry id holds the n bytes of q
+static int	contains(long id, const char *q, size_t n)
+{
+	const char	*s;
+	const char	*hit;
+	size_t		len;
+
+	s = history_text(id, &len);
+	while (len >= n)
+	{
+		hit = ft_memchr(s, q[0], len - n + 1);
+		if (!hit)
+			return (0);
+		len -= hit - s;
+		if (ft_memcmp(hit, q, n) == 0)
+			return (1);
+		s = hit + 1;
+		len--;
+	}
+	return (0);
+}
+
+// One cursor per distinct trigram of q, at the end of its list; 0 when
+// some trigram is in no entry at all, or no entry has any (no table)
+static int	open_cursors(const char *q, size_t n, t_cursor *c, int *count)
+{
+	t_postings	*list;
+	unsigned int	key;
+	size_t		i;
+	int		j;
+
+	*count = 0;
+	if (!g_search.table || g_search.slots == 0)
+		return (0);
+	i = 0;
+	while (i + 3 <= n && *count < SEARCH_MAX_GRAMS)
+	{
+		key = ((unsigned int)(unsigned char)q[i] << 16
+				| (unsigned char)q[i + 1] << 8 | (unsigned char)q[i + 2]) + 1;
+		list = lookup(key);
+		if (!list->key)
+			return (0);
+		j = 0;
+		while (j < *count && c[j].list != list)
+			j++;
+		if (j == *count)
+		{
+			c[*count].list = list;
+			c[*count].pos = list->len;
+			c[(*count)++].id = list->last;
+		}
+		i++;
+	}
+	return (1);
+}
+
+// The newest entry before entry `before` that holds query, or -1.
+// Queries shorter than a trigram are looked for line by line.
+long	search_history(const char *query, long before)
+{
+	t_cursor	c[SEARCH_MAX_GRAMS];
+	long		target;
+	size_t		n;
+	int		count;
+	int		i;
+
+	n = ft_strlen(query);
+	if (n == 0)
+		return (-1);
+	target = history_entries();
+	if (before < target)
+		target = before;
+	target--;
+	if (n >= 3 && update_index())
+	{
+		if (!open_cursors(query, n, c, &count))
+			return (-1);
+		while (target >= 0)
+		{
+			i = 0;
+			while (i < count && target >= 0)
+			{
+				seek(&c[i], target);
+				target = c[i++].id;
+			}
+			if (target >= 0 && c[0].id == target && contains(target, query, n))
+				return (target);
+			target -= (target >= 0 && c[0].id == target);
+		}
+		return (-1);
+	}
+	while (target >= 0 && !contains(target, query, n))
+		target--;
+	return (target);
+}
@@ -0,0 +1,118 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   cwd.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 00:31:44 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 00:31:46 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "env.h"
+
+// The logical working directory. The shell remembers the path cd was
+// given, with `.` and `..` resolved as text, rather than asking the
+// kernel: pwd costs nothing, and a directory reached through a symlink
+// keeps the name it was reached by, as $PWD does in bash.
+
+// Add the components of path to the canonical out[0..len), which has
+// no trailing slash; returns the new length
+static size_t	append_components(char *out, size_t len, const char *path)
+{
+	size_t	n;
+
+	while (*path)
+	{
+		while (*path == '/')
+			path++;
+		n = 0;
+		while (path[n] && path[n] != '/')
+			n++;
+		if (n == 2 && path[0] == '.' && path[1] == '.')
+		{
+			while (len > 0 && out[len - 1] != '/')
+				len--;
+			len -= (len > 0);
+		}
+		else if (n > 0 && !(n == 1 && path[0] == '.'))
+		{
+			out[len++] = '/';
+			ft_memcpy(out + len, path, n);
+			len += n;
+		}
+		path += n;
+	}
+	return (len);
+}
+
+// path made absolute against base, itself absolute, with empty and `.`
+// components dropped and each `..` taking away the one before it
+char	*canon_path(const char *base, const char *path)
+{
+	char	*out;
+	size_t	len;
+
+	out = malloc(ft_strlen(base) + ft_strlen(path) + 3);
+	if (!out)
+		return (NULL);
+	len = 0;
+	if (*path != '/')
+		len = append_components(out, 0, base);
+	len = append_components(out, len, path);
+	if (len == 0)
+		out[len++] = '/';
+	out[len] = '\0';
+	return (out);
+}
+
+static void	set_exported(t_env **env, char *key, char *value)
+{
+	set_env_value(env, key, value);
+	if (find_env(*env, key))
+		export_var(find_env(*env, key));
+}
+
+// Take $PWD when it is canonical and names the directory we are in,
+// as after a cd through a symlink in the parent shell; getcwd otherwise.
+// Under `env -i` PWD is the first variable, so *env may change.
+void	pwd_init(t_env **env)
+{
+	struct stat	here;
+	struct stat	st;
+	t_shell		*shell;
+	char		*pwd;
+
+	shell = get_shell();
+	pwd = get_env_value(*env, "PWD");
+	if (pwd && *pwd == '/' && stat(pwd, &st) == 0 && stat(".", &here) == 0
+		&& st.st_dev == here.st_dev && st.st_ino == here.st_ino)
+	{
+		shell->pwd = canon_path("/", pwd);
+		if (shell->pwd && ft_strncmp(shell->pwd, pwd, ft_strlen(pwd) + 1))
+		{
+			free(shell->pwd);
+			shell->pwd = NULL;
+		}
+	}
+	if (!shell->pwd)
+		shell->pwd = getcwd(NULL, 0);
+	if (shell->pwd)
+		set_exported(env, "PWD", shell->pwd);
+}
+
+// After a successful chdir: pwd, which is taken over, is the new working
+// directory; the old one becomes $OLDPWD
+void	pwd_set(t_env *env, char *pwd)
+{
+	t_shell	*shell;
+
+	shell = get_shell();
+	if (shell->pwd)
+		set_exported(&env, "OLDPWD", shell->pwd);
+	free(shell->pwd);
+	shell->pwd = pwd;
+	if (pwd)
+		set_exported(&env, "PWD", pwd);
+}
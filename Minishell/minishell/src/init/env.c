@@ -32,6 +32,8 @@ static t_env	*create_env_node(char *key, char *value)
 		free(node);
 		return (NULL);
 	}
+	node->exported = 0;
+	node->entry = NULL;
 	node->next = NULL;
 	return (node);
 }
@@ -73,7 +75,10 @@ t_env	*init_env(char **envp)
 			{
 				new_node = create_env_node(key, value);
 				if (new_node)
+				{
 					add_env_node(&env, new_node);
+					export_var(new_node);
+				}
 			}
 			free(key);
 			free(value);
@@ -83,21 +88,33 @@ t_env	*init_env(char **envp)
 	return (env);
 }
 
-char	*get_env_value(t_env *env, char *key)
+t_env	*find_env(t_env *env, const char *key)
 {
 	t_env	*current;
+	size_t	len;
 
+	// Comparing the terminator too matches the whole key in one pass
+	len = ft_strlen(key) + 1;
 	current = env;
 	while (current)
 	{
-		if (ft_strncmp(current->key, key, ft_strlen(key)) == 0 &&
-		    ft_strlen(current->key) == ft_strlen(key))
-			return (current->value);
+		if (ft_strncmp(current->key, key, len) == 0)
+			return (current);
 		current = current->next;
 	}
 	return (NULL);
 }
 
+char	*get_env_value(t_env *env, char *key)
+{
+	t_env	*var;
+
+	var = find_env(env, key);
+	if (!var)
+		return (NULL);
+	return (var->value);
+}
+
 void	free_env(t_env *env)
 {
 	t_env	*current;
@@ -107,6 +124,7 @@ void	free_env(t_env *env)
 	while (current)
 	{
 		next = current->next;
+		unexport_var(current);
 		free(current->key);
 		free(current->value);
 		free(current);
@@ -0,0 +1,157 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   exports.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 23:41:16 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 23:41:19 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "env.h"
+
+// The exported tier. Every variable lives in the t_env list; exported
+// ones are also indexed here, in the order they were exported, each
+// keeping its NAME=value string from one program run to the next. envp
+// is just that index, rebuilt only after an exported variable changed,
+// so shell-only variables cost nothing when a program starts.
+
+typedef struct s_exports
+{
+	t_env	**vars;
+	int	count;
+	int	cap;
+	char	**envp;
+	int	stale;	// envp does not match vars any more
+}	t_exports;
+
+static t_exports	g_exp;
+
+static int	index_of(t_env *var)
+{
+	int	i;
+
+	i = 0;
+	while (i < g_exp.count && g_exp.vars[i] != var)
+		i++;
+	if (i == g_exp.count)
+		return (-1);
+	return (i);
+}
+
+// Move var to the exported tier. Returns 0 on success.
+int	export_var(t_env *var)
+{
+	t_env	**grown;
+
+	if (var->exported)
+		return (0);
+	if (g_exp.count == g_exp.cap)
+	{
+		g_exp.cap = g_exp.cap ? g_exp.cap * 2 : 64;
+		grown = malloc(sizeof(t_env *) * g_exp.cap);
+		if (!grown)
+			return (1);
+		if (g_exp.vars)
+			ft_memcpy(grown, g_exp.vars, sizeof(t_env *) * g_exp.count);
+		free(g_exp.vars);
+		g_exp.vars = grown;
+	}
+	g_exp.vars[g_exp.count++] = var;
+	var->exported = 1;
+	g_exp.stale = 1;
+	return (0);
+}
+
+// Back to a shell variable, value kept
+void	unexport_var(t_env *var)
+{
+	int	i;
+
+	if (!var->exported)
+		return ;
+	i = index_of(var);
+	if (i >= 0)
+	{
+		ft_memmove(&g_exp.vars[i], &g_exp.vars[i + 1],
+			sizeof(t_env *) * (g_exp.count - i - 1));
+		g_exp.count--;
+	}
+	var->exported = 0;
+	free(var->entry);
+	var->entry = NULL;
+	g_exp.stale = 1;
+}
+
+// The value of var was replaced
+void	var_changed(t_env *var)
+{
+	free(var->entry);
+	var->entry = NULL;
+	if (var->exported)
+		g_exp.stale = 1;
+}
+
+// The variable in node from now lives in node to
+void	var_moved(t_env *from, t_env *to)
+{
+	int	i;
+
+	i = index_of(from);
+	if (i >= 0)
+		g_exp.vars[i] = to;
+	g_exp.stale = 1;
+}
+
+static char	*make_entry(t_env *var)
+{
+	char	*entry;
+	size_t	key_len;
+	size_t	value_len;
+
+	key_len = ft_strlen(var->key);
+	value_len = ft_strlen(var->value);
+	entry = malloc(key_len + value_len + 2);
+	if (!entry)
+		return (NULL);
+	ft_memcpy(entry, var->key, key_len);
+	entry[key_len] = '=';
+	ft_memcpy(entry + key_len + 1, var->value, value_len + 1);
+	return (entry);
+}
+
+// NAME=value for each exported variable. The array belongs to this
+// file and stays valid until an exported variable changes; fork() hands
+// a current one to children.
+char	**get_envp(void)
+{
+	char	**envp;
+	t_env	*var;
+	int	i;
+
+	if (g_exp.envp && !g_exp.stale)
+		return (g_exp.envp);
+	envp = malloc(sizeof(char *) * (g_exp.count + 1));
+	if (!envp)
+		return (NULL);
+	i = 0;
+	while (i < g_exp.count)
+	{
+		var = g_exp.vars[i];
+		if (!var->entry)
+			var->entry = make_entry(var);
+		if (!var->entry)
+		{
+			free(envp);
+			return (NULL);
+		}
+		envp[i++] = var->entry;
+	}
+	envp[i] = NULL;
+	free(g_exp.envp);
+	g_exp.envp = envp;
+	g_exp.stale = 0;
+	return (envp);
+}
@@ -0,0 +1,39 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   names.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 10:31:20 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 10:31:22 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "minishell.h"
+
+// Helpers for the shell's hash tables keyed by a string. They all
+// hash with FNV-1a; those keyed by a name chain their collisions
+// through t_named heads.
+
+unsigned long	hash_text(const char *s)
+{
+	unsigned long	h;
+
+	h = 1469598103934665603UL;
+	while (*s)
+		h = (h ^ (unsigned char)*s++) * 1099511628211UL;
+	return (h);
+}
+
+// The link in the chain at slot that points to the node called name,
+// or the NULL that ends the chain. Unlink with *link = (*link)->next.
+t_named	**named_link(t_named **slot, const char *name)
+{
+	size_t	len;
+
+	len = ft_strlen(name) + 1;
+	while (*slot && ft_strncmp((*slot)->name, name, len) != 0)
+		slot = &(*slot)->next;
+	return (slot);
+}
@@ -0,0 +1,21 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   shell.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 10:12:04 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 10:12:06 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "minishell.h"
+
+// Single instance of the shell state, zero-initialised on first use
+t_shell	*get_shell(void)
+{
+	static t_shell	shell;
+
+	return (&shell);
+}
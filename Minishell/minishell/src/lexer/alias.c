@@ -0,0 +1,147 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   alias.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:31:05 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:31:08 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "lexer.h"
+
+// Aliases. A definition is lexed once, when it is made, and kept as a
+// token list; the lexer splices copies of those tokens in place of a
+// word in command position, so using an alias never scans its text
+// again. The table is chained like the function table.
+
+#define ALIAS_SLOTS 64
+
+static t_alias	*g_aliases[ALIAS_SLOTS];
+static int	g_alias_count;
+static int	g_alias_generation;	// bumped by every change to the table
+
+static t_named	**slot(const char *name)
+{
+	return ((t_named **)&g_aliases[hash_text(name) % ALIAS_SLOTS]);
+}
+
+t_alias	*find_alias(const char *name)
+{
+	if (g_alias_count == 0)
+		return (NULL);
+	return ((t_alias *)*named_link(slot(name), name));
+}
+
+static void	free_alias(t_alias *alias)
+{
+	free(alias->name);
+	free(alias->text);
+	free_tokens(alias->tokens);
+	free(alias);
+}
+
+// Take name out of the table. Returns 1 if it was defined.
+int	remove_alias(const char *name)
+{
+	t_named	**link;
+	t_alias	*alias;
+
+	link = named_link(slot(name), name);
+	alias = (t_alias *)*link;
+	if (!alias)
+		return (0);
+	*link = (*link)->next;
+	g_alias_count--;
+	g_alias_generation++;
+	free_alias(alias);
+	return (1);
+}
+
+void	remove_all_aliases(void)
+{
+	t_alias	*next;
+	int	i;
+
+	i = 0;
+	while (i < ALIAS_SLOTS)
+	{
+		while (g_aliases[i])
+		{
+			next = g_aliases[i]->next;
+			free_alias(g_aliases[i]);
+			g_aliases[i] = next;
+		}
+		i++;
+	}
+	g_alias_count = 0;
+	g_alias_generation++;
+}
+
+// alias name=text. Returns 0 on success.
+int	define_alias(const char *name, const char *text)
+{
+	t_alias	*alias;
+	size_t	len;
+
+	alias = ft_calloc(1, sizeof(t_alias));
+	if (!alias)
+		return (1);
+	alias->name = ft_strdup(name);
+	alias->text = ft_strdup(text);
+	if (!alias->name || !alias->text)
+	{
+		free_alias(alias);
+		return (1);
+	}
+	// Lexed without alias expansion: that happens where it is used
+	alias->tokens = lexer_raw(alias->text);
+	len = ft_strlen(text);
+	alias->blank = (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t'));
+	remove_alias(name);
+	alias->next = (t_alias *)*slot(name);
+	*slot(name) = (t_named *)alias;
+	g_alias_count++;
+	g_alias_generation++;
+	return (0);
+}
+
+// Changes when any alias is defined or removed, for text lexed ahead
+int	alias_generation(void)
+{
+	return (g_alias_generation);
+}
+
+// Every alias, sorted by name, in a new array of *count entries
+t_alias	**list_aliases(int *count)
+{
+	t_alias	**list;
+	t_alias	*alias;
+	int	i;
+	int	j;
+
+	*count = 0;
+	list = malloc(sizeof(t_alias *) * (g_alias_count + 1));
+	if (!list)
+		return (NULL);
+	i = -1;
+	while (++i < ALIAS_SLOTS)
+	{
+		alias = g_aliases[i];
+		while (alias)
+		{
+			j = (*count)++;
+			while (j > 0 && ft_strncmp(list[j - 1]->name, alias->name,
+					ft_strlen(alias->name) + 1) > 0)
+			{
+				list[j] = list[j - 1];
+				j--;
+			}
+			list[j] = alias;
+			alias = alias->next;
+		}
+	}
+	return (list);
+}
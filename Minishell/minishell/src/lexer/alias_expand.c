@@ -0,0 +1,105 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   alias_expand.c                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 22:38:44 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 22:38:46 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "lexer.h"
+#include "parser.h"
+
+// Splicing aliases into the token list as the lexer produces it. Only
+// a word in command position is looked up: the first word of a command,
+// the word after a reserved word that starts a list or after a NAME=value
+// prefix, and the word after an alias whose text ends in a blank.
+
+static int	is_list_start(t_token *tok)
+{
+	static const char	*words[] = {"{", "!", "if", "then", "elif", "else",
+		"while", "until", "do", NULL};
+	int			i;
+
+	i = 0;
+	while (words[i] && ft_strncmp(tok->value, words[i],
+			ft_strlen(words[i]) + 1) != 0)
+		i++;
+	return (words[i] != NULL);
+}
+
+// Where tok leaves the scan: whether the next word names a command
+static void	advance(t_alias_scan *scan, t_token *tok)
+{
+	if (tok->type != TOKEN_WORD)
+	{
+		// A redirection operator is followed by its target word
+		scan->target = (tok->type != TOKEN_PIPE && tok->type != TOKEN_LPAREN
+				&& tok->type != TOKEN_RPAREN && tok->type != TOKEN_SEMICOLON);
+		if (!scan->target)
+			scan->command = 1;
+		return ;
+	}
+	if (scan->target)
+		scan->target = 0;
+	else
+		scan->command = (scan->command && (is_list_start(tok)
+					|| is_assignment(tok->value)));
+}
+
+static t_token	*copy_token(t_token *tok)
+{
+	t_token	*copy;
+
+	copy = malloc(sizeof(t_token));
+	if (!copy)
+		return (NULL);
+	*copy = *tok;
+	copy->next = NULL;
+	copy->value = ft_strdup(tok->value);
+	if (!copy->value)
+	{
+		free(copy);
+		return (NULL);
+	}
+	return (copy);
+}
+
+// Append tok at *tail, or the tokens of its alias in its place. An alias
+// is not expanded again inside its own expansion, so `alias ls='ls -F'`
+// ends. Returns 0 when out of memory; tok is consumed either way.
+int	alias_append(t_token ***tail, t_token *tok, t_alias_scan *scan)
+{
+	t_alias	*alias;
+	t_token	*it;
+	t_token	*copy;
+	int	ok;
+
+	alias = NULL;
+	if (tok->type == TOKEN_WORD && scan->command && !scan->target)
+		alias = find_alias(tok->value);
+	if (!alias || alias->active)
+	{
+		advance(scan, tok);
+		**tail = tok;
+		*tail = &tok->next;
+		return (1);
+	}
+	free_tokens(tok);
+	alias->active = 1;
+	ok = 1;
+	it = alias->tokens;
+	while (ok && it)
+	{
+		copy = copy_token(it);
+		ok = (copy && alias_append(tail, copy, scan));
+		it = it->next;
+	}
+	alias->active = 0;
+	if (alias->blank)
+		scan->command = 1;
+	return (ok);
+}
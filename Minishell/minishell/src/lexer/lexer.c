@@ -29,28 +29,37 @@ static t_token	*create_token(char *value, t_token_type type)
 	}
 	token->type = type;
 	token->quote_type = 0;
+	token->io_number = -1;
 	token->next = NULL;
 	return (token);
 }
 
-static void	add_token(t_token **tokens, t_token *new_token)
+// Link new_token at *tail, the next pointer of the last token, so that
+// a long line is not walked again for every token
+static void	add_token(t_token ***tail, t_token *new_token)
 {
-	t_token	*current;
+	**tail = new_token;
+	*tail = &new_token->next;
+}
 
-	if (!*tokens)
-	{
-		*tokens = new_token;
-		return ;
-	}
-	current = *tokens;
-	while (current->next)
-		current = current->next;
-	current->next = new_token;
+// line[start..start+len) as a new string. ft_substr would measure the
+// whole rest of the line for every word.
+static char	*copy_span(const char *line, int start, int len)
+{
+	char	*copy;
+
+	copy = malloc(len + 1);
+	if (!copy)
+		return (NULL);
+	ft_memcpy(copy, line + start, len);
+	copy[len] = '\0';
+	return (copy);
 }
 
 static int	is_metachar(char c)
 {
-	return (c == '|' || c == '<' || c == '>');
+	return (c == '|' || c == '<' || c == '>'
+		|| c == '(' || c == ')' || c == ';');
 }
 
 static int	is_whitespace(char c)
@@ -58,138 +67,193 @@ static int	is_whitespace(char c)
 	return (c == ' ' || c == '\t' || c == '\n');
 }
 
-static char	*extract_quoted_content(char *line, int *i, char quote_char, int *quoted)
+// `$(`, `${`, `<(` or `>(` opens a substitution, which is part of a word
+static int	starts_substitution(char *line, int i)
 {
-	char	*content;
-	int	start;
-	int	len;
+	if (line[i] == '$' && line[i + 1] == '{')
+		return (1);
+	return ((line[i] == '$' || line[i] == '<' || line[i] == '>')
+		&& line[i + 1] == '(');
+}
+
+// `$(` or `${` inside double quotes nests its own quoting
+static int	nested_in_dquote(const char *s, int i)
+{
+	return (s[i] == '$' && (s[i + 1] == '(' || s[i + 1] == '{'));
+}
+
+// Index just past the ')' or '}' matching the '(' or '{' at s[i], or -1
+// when it is never closed. Brackets inside quotes do not count.
+int	match_paren(const char *s, int i)
+{
+	int	depth;
+	char	quote;
+	char	open;
+	char	close;
+
+	open = s[i];
+	close = (open == '{') ? '}' : ')';
+	depth = 0;
+	quote = 0;
+	while (s[i])
+	{
+		if (quote == '"' && nested_in_dquote(s, i))
+		{
+			i = match_paren(s, i + 1);
+			if (i == -1)
+				return (-1);
+			continue ;
+		}
+		if (quote && s[i] == quote)
+			quote = 0;
+		else if (!quote && (s[i] == '\'' || s[i] == '"'))
+			quote = s[i];
+		else if (!quote && s[i] == open)
+			depth++;
+		else if (!quote && s[i] == close && --depth == 0)
+			return (i + 1);
+		i++;
+	}
+	return (-1);
+}
 
+static int	skip_quoted(char *line, int *i, char quote_char)
+{
 	(*i)++; // Skip opening quote
-	start = *i;
-	*quoted = 1;
-	
 	while (line[*i] && line[*i] != quote_char)
-		(*i)++;
-	
-	if (line[*i] != quote_char)
 	{
-		// Unclosed quote - return NULL to indicate error
-		return (NULL);
+		if (quote_char == '"' && nested_in_dquote(line, *i))
+		{
+			*i = match_paren(line, *i + 1);
+			if (*i == -1)
+				return (0);
+		}
+		else
+			(*i)++;
 	}
-	
-	len = *i - start;
-	content = malloc(len + 1);
-	if (!content)
-		return (NULL);
-	ft_strlcpy(content, line + start, len + 1);
+	if (line[*i] != quote_char)
+		return (0); // Unclosed quote
 	(*i)++; // Skip closing quote
-	return (content);
+	return (1);
 }
 
+// Words are kept verbatim (quotes included) so that expansion can run
+// later, when the command is about to execute, and still know which
+// parts were quoted.
 static char	*extract_word_with_quotes(char *line, int *i, int *quote_type)
 {
-	char	*result;
-	char	*temp;
-	char	*quoted_content;
 	int	start;
-	int	len;
-	int	is_quoted;
+	int	kind;
+	int	end;
 
-	result = ft_strdup("");
-	if (!result)
-		return (NULL);
-	
 	*quote_type = 0; // 0=no quotes, 1=single, 2=double, 3=mixed
-	
-	while (line[*i] && !is_whitespace(line[*i]) && !is_metachar(line[*i]))
+	start = *i;
+	while (line[*i] && !is_whitespace(line[*i]))
 	{
-		is_quoted = 0;
-		if (line[*i] == '\'' || line[*i] == '"')
+		if (starts_substitution(line, *i))
 		{
-			char quote_char = line[*i];
+			end = match_paren(line, *i + 1);
+			if (end == -1)
+				return (NULL); // Unclosed substitution
+			*i = end;
+		}
+		else if (is_metachar(line[*i]))
+			break ;
+		else if (line[*i] == '\'' || line[*i] == '"')
+		{
+			kind = (line[*i] == '\'') ? 1 : 2;
 			if (*quote_type == 0)
-				*quote_type = (quote_char == '\'') ? 1 : 2;
-			else if (*quote_type != ((quote_char == '\'') ? 1 : 2))
+				*quote_type = kind;
+			else if (*quote_type != kind)
 				*quote_type = 3; // Mixed quotes
-			
-			quoted_content = extract_quoted_content(line, i, quote_char, &is_quoted);
-			if (!quoted_content)
-			{
-				free(result);
+			if (!skip_quoted(line, i, line[*i]))
 				return (NULL); // Unclosed quote
-			}
-			temp = ft_strjoin(result, quoted_content);
-			free(result);
-			free(quoted_content);
-			result = temp;
 		}
 		else
-		{
-			// Regular character
-			start = *i;
-			while (line[*i] && line[*i] != '\'' && line[*i] != '"' 
-				&& !is_whitespace(line[*i]) && !is_metachar(line[*i]))
-				(*i)++;
-			len = *i - start;
-			if (len > 0)
-			{
-				char *unquoted_part = malloc(len + 1);
-				if (!unquoted_part)
-				{
-					free(result);
-					return (NULL);
-				}
-				ft_strlcpy(unquoted_part, line + start, len + 1);
-				temp = ft_strjoin(result, unquoted_part);
-				free(result);
-				free(unquoted_part);
-				result = temp;
-			}
-		}
-		if (!result)
-			return (NULL);
+			(*i)++;
 	}
-	
-	return (result);
+	return (copy_span(line, start, *i - start));
 }
 
 static t_token_type	get_redirect_type(char *line, int *i)
 {
-	if (line[*i] == '<')
-	{
-		if (line[*i + 1] == '<')
-		{
-			(*i) += 2;
-			return (TOKEN_HEREDOC);
-		}
-		(*i)++;
-		return (TOKEN_REDIRECT_IN);
-	}
-	else if (line[*i] == '>')
+	static const struct { const char *op; t_token_type type; } ops[] = {
+		{"<<", TOKEN_HEREDOC}, {"<>", TOKEN_REDIRECT_RDWR},
+		{"<&", TOKEN_DUP_IN}, {">>", TOKEN_APPEND},
+		{">|", TOKEN_CLOBBER}, {">&", TOKEN_DUP_OUT},
+		{"<", TOKEN_REDIRECT_IN}, {">", TOKEN_REDIRECT_OUT}};
+	size_t	k;
+	size_t	len;
+
+	k = 0;
+	while (k < sizeof(ops) / sizeof(ops[0]))
 	{
-		if (line[*i + 1] == '>')
+		len = ft_strlen(ops[k].op);
+		if (ft_strncmp(line + *i, ops[k].op, len) == 0)
 		{
-			(*i) += 2;
-			return (TOKEN_APPEND);
+			(*i) += len;
+			return (ops[k].type);
 		}
-		(*i)++;
-		return (TOKEN_REDIRECT_OUT);
+		k++;
 	}
 	return (TOKEN_WORD);
 }
 
-t_token	*lexer(char *line)
+// Digits directly followed by '<' or '>' name the fd to redirect (2>err)
+static int	io_number_length(char *line, int i)
+{
+	int	start;
+
+	start = i;
+	while (ft_isdigit(line[i]))
+		i++;
+	if (i > start && i - start < 5 && (line[i] == '<' || line[i] == '>')
+		&& !starts_substitution(line, i))
+		return (i - start);
+	return (0);
+}
+
+static t_token	*lex_redirect(char *line, int *i)
+{
+	t_token	*token;
+	char	*op;
+	int	start;
+	int	digits;
+
+	start = *i;
+	digits = io_number_length(line, *i);
+	*i += digits;
+	if (get_redirect_type(line, i) == TOKEN_WORD)
+		return (NULL);
+	op = copy_span(line, start, *i - start);
+	if (!op)
+		return (NULL);
+	token = create_token(op, TOKEN_WORD);
+	free(op);
+	if (!token)
+		return (NULL);
+	start += digits;
+	token->type = get_redirect_type(line, &start);
+	if (digits)
+		token->io_number = ft_atoi(token->value);
+	return (token);
+}
+
+// Aliases are expanded as tokens are added, unless scan is NULL
+static t_token	*lex(char *line, t_alias_scan *scan)
 {
 	t_token	*tokens;
+	t_token	**tail;
 	t_token	*new_token;
 	char	*word;
 	int	i;
 
 	tokens = NULL;
+	tail = &tokens;
 	i = 0;
 	while (line[i])
 	{
-		while (is_whitespace(line[i]))
+		while (line[i] == ' ' || line[i] == '\t')
 			i++;
 		if (!line[i])
 			break ;
@@ -198,34 +262,63 @@ t_token	*lexer(char *line)
 			new_token = create_token("|", TOKEN_PIPE);
 			i++;
 		}
-		else if (is_metachar(line[i]))
+		else if (line[i] == '\n')
+		{
+			// A line break ends a command like `;' does
+			new_token = create_token("\n", TOKEN_SEMICOLON);
+			i++;
+		}
+		else if (line[i] == '(' || line[i] == ')' || line[i] == ';')
 		{
-			t_token_type type = get_redirect_type(line, &i);
-			if (type == TOKEN_HEREDOC)
-				new_token = create_token("<<", type);
-			else if (type == TOKEN_APPEND)
-				new_token = create_token(">>", type);
-			else if (type == TOKEN_REDIRECT_IN)
-				new_token = create_token("<", type);
+			if (line[i] == '(')
+				new_token = create_token("(", TOKEN_LPAREN);
+			else if (line[i] == ')')
+				new_token = create_token(")", TOKEN_RPAREN);
 			else
-				new_token = create_token(">", type);
+				new_token = create_token(";", TOKEN_SEMICOLON);
+			i++;
 		}
+		else if ((is_metachar(line[i]) && !starts_substitution(line, i))
+			|| io_number_length(line, i))
+			new_token = lex_redirect(line, &i);
 		else
 		{
 			int quote_type;
 			word = extract_word_with_quotes(line, &i, &quote_type);
 			if (!word)
+			{
+				free_tokens(tokens);
 				return (NULL); // Error (e.g., unclosed quotes)
+			}
 			
 			new_token = create_token(word, TOKEN_WORD);
 			if (new_token)
 				new_token->quote_type = quote_type;
 			free(word);
 		}
-		if (!new_token)
+		if (!new_token || (scan && !alias_append(&tail, new_token, scan)))
+		{
+			free_tokens(tokens);
 			return (NULL);
-		add_token(&tokens, new_token);
+		}
+		if (!scan)
+			add_token(&tail, new_token);
 	}
 	return (tokens);
 }
 
+t_token	*lexer(char *line)
+{
+	t_alias_scan	scan;
+
+	scan.command = 1;
+	scan.target = 0;
+	return (lex(line, &scan));
+}
+
+// For the text of an alias: no alias is expanded
+t_token	*lexer_raw(char *line)
+{
+	return (lex(line, NULL));
+}
+
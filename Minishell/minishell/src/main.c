@@ -14,13 +14,69 @@
 #include "lexer.h"
 #include "parser.h"
 #include "env.h"
-#include "expander.h"
 #include "executor.h"
+#include "optimizer.h"
 #include "signals.h"
+#include "history.h"
+#include "builtins.h"
 
 // Global variable for signal handling
 volatile sig_atomic_t g_sig = 0;
 
+// Ctrl-C while the command was read: drop what was read of it
+static t_command	*interrupted(char **line, t_command *cmd)
+{
+	free_command(cmd);
+	heredoc_clear();
+	free(*line);
+	*line = NULL;
+	return (NULL);
+}
+
+// Parse *tokens, reading more lines while they end inside an if, a
+// loop or a case. *line and *tokens are replaced by the joined input.
+static t_command	*read_command(char **line, t_token **tokens)
+{
+	t_command	*cmd;
+	char		*more;
+	char		*joined;
+	int		incomplete;
+
+	if (!heredoc_collect(*tokens))
+		return (g_sig == SIGINT ? interrupted(line, NULL) : NULL);
+	cmd = parse_input(*tokens, &incomplete);
+	while (incomplete)
+	{
+		more = input_line("> ");
+		if (g_sig == SIGINT)
+		{
+			free(more);
+			return (interrupted(line, cmd));
+		}
+		if (!more)
+		{
+			fprintf(stderr, "minishell: syntax error: unexpected end of file\n");
+			get_shell()->last_status = 2;
+			return (NULL);
+		}
+		joined = ft_strjoin(*line, "\n");
+		free(*line);
+		*line = NULL;
+		if (joined)
+			*line = ft_strjoin(joined, more);
+		free(joined);
+		free(more);
+		free_tokens(*tokens);
+		*tokens = NULL;
+		if (!*line)
+			return (NULL);
+		*tokens = lexer(*line);
+		if (!heredoc_collect(*tokens))
+			return (g_sig == SIGINT ? interrupted(line, NULL) : NULL);
+		cmd = parse_input(*tokens, &incomplete);
+	}
+	return (cmd);
+}
 
 int	main(int argc, char **argv, char **envp)
 {
@@ -31,47 +87,48 @@ int	main(int argc, char **argv, char **envp)
 	t_token *tokens;
 	t_command *cmd;
 	t_env *env;
-	int exit_status = 0;
 
 	env = init_env(envp);
+	pwd_init(&env);
 	setup_signals();
+	get_shell()->interactive = isatty(STDIN_FILENO);
+	if (get_shell()->interactive)
+	{
+		history_init(env);
+		complete_init(env);
+	}
 	
     while (1)
     {
-        line = readline("minishell$ ");
+        path_cache_expire();
+        cdpath_expire();
+        line = input_line("minishell$ ");
         if (!line)
         {
-            printf("exit\n");
+            if (get_shell()->interactive)
+                fprintf(stderr, "exit\n");
             break ;
         }
         tokens = lexer(line);
-        if (tokens)
-        {
-            // Expand variables in tokens
-            expand_tokens(tokens, env, exit_status);
-            // Drop empty tokens produced by expansion (no word splitting)
-            compact_empty_tokens(&tokens);
-        }
 
-        // If the line is empty after expansion, do not add to history and no-op
+        // Nothing to run (empty line or unclosed quote): no history entry
         if (!tokens)
         {
             free(line);
-            // Keep exit_status unchanged (bash returns 0 for no-op)
             continue;
         }
 
-        // Add to history only if something remains after expansion
-        if (line[0] != '\0')
-            add_history(line);
-
-        cmd = parse(tokens);
+        cmd = optimize_command(read_command(&line, &tokens));
+        heredoc_clear();
+        if (line)
+            history_add(line);
 
-        // Execute the command
+        // Words are expanded by the executor, right before each command
+        // runs, so that `;` lists see the effect of earlier commands
+        g_sig = 0;
         if (cmd)
-        {
-            exit_status = execute_command(cmd, env);
-        }
+            execute_command(cmd, env);
+        fflush(stdout); // what readline's prompt used to do for scripts
         
         free_command(cmd);
         free_tokens(tokens);
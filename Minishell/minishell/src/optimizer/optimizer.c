@@ -0,0 +1,167 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   optimizer.c                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 13:31:20 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 13:31:22 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "optimizer.h"
+#include "executor.h"
+#include "vm.h"
+
+static void	explain(const char *what, const char *arg)
+{
+	if (!(get_shell()->options & OPT_EXPLAIN))
+		return ;
+	if (arg)
+		fprintf(stderr, "minishell: optimize: %s%s'\n", what, arg);
+	else
+		fprintf(stderr, "minishell: optimize: %s\n", what);
+}
+
+static int	is_cat(t_command *cmd)
+{
+	return (cmd && cmd->type == CMD_SIMPLE && !cmd->data.simple.redirs
+		&& !cmd->data.simple.assigns && cmd->data.simple.args
+		&& ft_strncmp(cmd->data.simple.args[0], "cat", 4) == 0
+		&& !find_function("cat"));
+}
+
+// A word that names one file no matter how it is expanded
+static int	is_literal_file(const char *word)
+{
+	int	i;
+
+	if (!word[0] || word[0] == '-')
+		return (0);
+	i = 0;
+	while (word[i])
+	{
+		if (ft_strchr("$*?[{~`\\", word[i]))
+			return (0);
+		i++;
+	}
+	return (1);
+}
+
+// `cat FILE` with exactly one plain file argument
+static int	is_useless_cat(t_command *cmd)
+{
+	char	**args;
+
+	if (!is_cat(cmd))
+		return (0);
+	args = cmd->data.simple.args;
+	return (args[1] && !args[2] && is_literal_file(args[1]));
+}
+
+// `cat` on its own just copies stdin to stdout
+static int	is_trivial_cat(t_command *cmd)
+{
+	return (is_cat(cmd) && !cmd->data.simple.args[1]);
+}
+
+// cat FILE | next ...  =>  next < FILE ...  The pipeline decides as it
+// starts: the shell opens FILE for the next stage when it is a regular
+// file, and runs the cat otherwise, so that a missing file or a
+// directory still gets cat's error and the next stage still runs.
+static void	mark_leading_cat(t_command *pipe)
+{
+	t_command	*cat;
+
+	cat = pipe->data.pipe_cmd.left;
+	if (!is_useless_cat(cat))
+		return ;
+	pipe->data.pipe_cmd.feed = 1;
+	explain("`cat FILE |' becomes, for a regular file, `< ",
+		cat->data.simple.args[1]);
+}
+
+// a | cat | b  =>  a | b   (never the first or last stage, where the
+// copy may be there on purpose, e.g. to hide a terminal from `ls`)
+static void	drop_middle_cats(t_command *pipe)
+{
+	t_command	*next;
+
+	while (pipe->type == CMD_PIPE
+		&& pipe->data.pipe_cmd.right->type == CMD_PIPE)
+	{
+		next = pipe->data.pipe_cmd.right;
+		if (is_trivial_cat(next->data.pipe_cmd.left))
+		{
+			explain("dropped a `| cat |' stage", NULL);
+			pipe->data.pipe_cmd.right = next->data.pipe_cmd.right;
+			free_command(next->data.pipe_cmd.left);
+			free(next);
+		}
+		else
+			pipe = next;
+	}
+}
+
+static t_command	*optimize_node(t_command *cmd);
+
+// Optimize inside each stage first, then rewrite the chain as a whole
+static t_command	*optimize_pipeline(t_command *cmd)
+{
+	t_command	*node;
+
+	node = cmd;
+	while (node->type == CMD_PIPE)
+	{
+		node->data.pipe_cmd.left = optimize_node(node->data.pipe_cmd.left);
+		if (node->data.pipe_cmd.right->type != CMD_PIPE)
+			node->data.pipe_cmd.right
+				= optimize_node(node->data.pipe_cmd.right);
+		node = node->data.pipe_cmd.right;
+	}
+	drop_middle_cats(cmd);
+	mark_leading_cat(cmd);
+	return (cmd);
+}
+
+// The command trees a compiled if/while/for/case runs
+static void	optimize_program(t_vm_prog *prog)
+{
+	int	i;
+
+	i = 0;
+	while (i < prog->len)
+	{
+		if (prog->code[i].op == VOP_RUN)
+			prog->code[i].cmd = optimize_node(prog->code[i].cmd);
+		i++;
+	}
+}
+
+static t_command	*optimize_node(t_command *cmd)
+{
+	if (!cmd)
+		return (NULL);
+	if (cmd->type == CMD_LIST)
+	{
+		cmd->data.list.left = optimize_node(cmd->data.list.left);
+		cmd->data.list.right = optimize_node(cmd->data.list.right);
+	}
+	else if (cmd->type == CMD_SUBSHELL || cmd->type == CMD_GROUP)
+		cmd->data.subshell.body = optimize_node(cmd->data.subshell.body);
+	else if (cmd->type == CMD_FUNCDEF)
+		cmd->data.funcdef.body = optimize_node(cmd->data.funcdef.body);
+	else if (cmd->type == CMD_COMPOUND)
+		optimize_program(cmd->data.compound.prog);
+	else if (cmd->type == CMD_PIPE)
+		cmd = optimize_pipeline(cmd);
+	return (cmd);
+}
+
+t_command	*optimize_command(t_command *cmd)
+{
+	if (!(get_shell()->options & OPT_OPTIMIZE))
+		return (cmd);
+	return (optimize_node(cmd));
+}
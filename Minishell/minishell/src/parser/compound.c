@@ -0,0 +1,338 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   compound.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 21:14:50 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 21:14:52 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "parser.h"
+#include "vm.h"
+
+// if/while/until/for/case. They are compiled while they are parsed: each
+// list inside is lowered straight into the instruction stream of one
+// t_vm_prog, so a loop body is never lexed or parsed again however many
+// times it runs. Jumps forward are chained through their arg until the
+// target is known (vm_patch_chain).
+
+int	is_compound_start(t_token *token)
+{
+	return (is_reserved(token, "if") || is_reserved(token, "while")
+		|| is_reserved(token, "until") || is_reserved(token, "for")
+		|| is_reserved(token, "case"));
+}
+
+static int	expect(t_token **tokens, const char *word)
+{
+	skip_newlines(tokens);
+	if (!is_reserved(*tokens, word))
+	{
+		syntax_error(*tokens);
+		return (0);
+	}
+	*tokens = (*tokens)->next;
+	return (1);
+}
+
+// Parse a list and lower it into prog
+static int	emit_list(t_vm_prog *prog, t_token **tokens)
+{
+	t_command	*list;
+
+	list = parse_list(tokens);
+	if (!list)
+		return (0);
+	return (vm_emit_command(prog, list));
+}
+
+static int	emit_slot(t_vm_prog *prog, int op, int arg, int slot)
+{
+	int	at;
+
+	at = vm_emit(prog, op, arg);
+	if (at >= 0)
+		prog->code[at].slot = slot;
+	return (at);
+}
+
+// if list then list [elif list then list]... [else list] fi
+static int	parse_if(t_vm_prog *prog, t_token **tokens)
+{
+	int	done;
+	int	skip;
+
+	done = -1;
+	while (1)
+	{
+		*tokens = (*tokens)->next;
+		if (!emit_list(prog, tokens) || !expect(tokens, "then"))
+			return (0);
+		skip = vm_emit(prog, VOP_JUMP_FAIL, -1);
+		if (!emit_list(prog, tokens))
+			return (0);
+		done = vm_emit(prog, VOP_JUMP, done);
+		vm_patch(prog, skip);
+		skip_newlines(tokens);
+		if (!is_reserved(*tokens, "elif"))
+			break ;
+	}
+	if (is_reserved(*tokens, "else"))
+	{
+		*tokens = (*tokens)->next;
+		if (!emit_list(prog, tokens))
+			return (0);
+	}
+	else
+		vm_emit(prog, VOP_STATUS, 0); // no branch taken
+	vm_patch_chain(prog, done);
+	return (expect(tokens, "fi"));
+}
+
+// while|until list do list done. The loop's status is that of the last
+// body run, 0 when the body never ran.
+static int	parse_while(t_vm_prog *prog, t_token **tokens)
+{
+	int	until;
+	int	slot;
+	int	top;
+	int	leave;
+
+	until = is_reserved(*tokens, "until");
+	*tokens = (*tokens)->next;
+	slot = prog->slots++;
+	emit_slot(prog, VOP_LOOP_INIT, 0, slot);
+	top = prog->len;
+	if (!emit_list(prog, tokens) || !expect(tokens, "do"))
+		return (0);
+	leave = vm_emit(prog, until ? VOP_JUMP_OK : VOP_JUMP_FAIL, -1);
+	if (!emit_list(prog, tokens))
+		return (0);
+	emit_slot(prog, VOP_SAVE, 0, slot);
+	vm_emit(prog, VOP_JUMP, top);
+	vm_patch(prog, leave);
+	emit_slot(prog, VOP_RESTORE, 0, slot);
+	vm_close_loop(prog, top, top);
+	return (expect(tokens, "done"));
+}
+
+static char	**free_words(char **words)
+{
+	int	i;
+
+	i = 0;
+	while (words && words[i])
+		free(words[i++]);
+	free(words);
+	return (NULL);
+}
+
+// Words of `for name in words` up to the `;` or line break, as a new
+// array; "$@" when there is no `in`
+static char	**for_words(t_token **tokens)
+{
+	t_token	*it;
+	char	**words;
+	int	n;
+
+	if (!is_reserved(*tokens, "in"))
+	{
+		words = ft_calloc(2, sizeof(char *));
+		if (words)
+			words[0] = ft_strdup("\"$@\"");
+		if (words && !words[0])
+			return (free_words(words));
+		if (words && *tokens && (*tokens)->type == TOKEN_SEMICOLON
+			&& !is_newline(*tokens))
+			*tokens = (*tokens)->next;
+		return (words);
+	}
+	*tokens = (*tokens)->next;
+	n = 0;
+	it = *tokens;
+	while (it && it->type == TOKEN_WORD && ++n)
+		it = it->next;
+	words = ft_calloc(n + 1, sizeof(char *));
+	n = 0;
+	while (words && *tokens != it)
+	{
+		words[n] = ft_strdup((*tokens)->value);
+		if (!words[n++])
+			return (free_words(words));
+		*tokens = (*tokens)->next;
+	}
+	if (*tokens && (*tokens)->type == TOKEN_SEMICOLON && !is_newline(*tokens))
+		*tokens = (*tokens)->next;
+	return (words);
+}
+
+static int	is_name(const char *s)
+{
+	if (!ft_isalpha(*s) && *s != '_')
+		return (0);
+	while (ft_isalnum(*s) || *s == '_')
+		s++;
+	return (*s == '\0');
+}
+
+// for name [in word...] do list done
+static int	parse_for(t_vm_prog *prog, t_token **tokens)
+{
+	t_vm_insn	*next;
+	int		slot;
+	int		top;
+	int		at;
+
+	*tokens = (*tokens)->next;
+	if (!*tokens || (*tokens)->type != TOKEN_WORD || !is_name((*tokens)->value))
+	{
+		syntax_error(*tokens);
+		return (0);
+	}
+	slot = prog->slots++;
+	at = emit_slot(prog, VOP_LOOP_INIT, 0, slot);
+	top = emit_slot(prog, VOP_FOR_NEXT, -1, slot);
+	if (at < 0 || top < 0)
+		return (0);
+	next = &prog->code[top];
+	next->name = ft_strdup((*tokens)->value);
+	*tokens = (*tokens)->next;
+	skip_newlines(tokens);
+	prog->code[at].words = for_words(tokens);
+	if (!next->name || !prog->code[at].words || !expect(tokens, "do")
+		|| !emit_list(prog, tokens))
+		return (0);
+	emit_slot(prog, VOP_SAVE, 0, slot);
+	vm_emit(prog, VOP_JUMP, top);
+	vm_patch(prog, top);
+	emit_slot(prog, VOP_RESTORE, 0, slot);
+	vm_close_loop(prog, top, top);
+	return (expect(tokens, "done"));
+}
+
+// Instruction at whose words[0] a copy of the current word goes
+static int	emit_word(t_vm_prog *prog, t_token **tokens, int op, int slot)
+{
+	int	at;
+
+	if (!*tokens || (*tokens)->type != TOKEN_WORD)
+	{
+		syntax_error(*tokens);
+		return (-1);
+	}
+	at = emit_slot(prog, op, -1, slot);
+	if (at < 0)
+		return (-1);
+	prog->code[at].words = ft_calloc(2, sizeof(char *));
+	if (!prog->code[at].words)
+		return (-1);
+	prog->code[at].words[0] = ft_strdup((*tokens)->value);
+	if (!prog->code[at].words[0])
+		return (-1);
+	*tokens = (*tokens)->next;
+	return (at);
+}
+
+// [(] pattern [| pattern]... ) [list] [;;], matches chained to the body
+static int	parse_case_item(t_vm_prog *prog, t_token **tokens, int slot,
+		int *done)
+{
+	int	matches;
+	int	at;
+	int	skip;
+
+	if (*tokens && (*tokens)->type == TOKEN_LPAREN)
+		*tokens = (*tokens)->next;
+	matches = -1;
+	while (1)
+	{
+		at = emit_word(prog, tokens, VOP_CASE_MATCH, slot);
+		if (at < 0)
+			return (0);
+		prog->code[at].arg = matches;
+		matches = at;
+		if (!*tokens || (*tokens)->type != TOKEN_PIPE)
+			break ;
+		*tokens = (*tokens)->next;
+	}
+	if (!*tokens || (*tokens)->type != TOKEN_RPAREN)
+	{
+		syntax_error(*tokens);
+		return (0);
+	}
+	*tokens = (*tokens)->next;
+	skip = vm_emit(prog, VOP_JUMP, -1);
+	vm_patch_chain(prog, matches);
+	skip_newlines(tokens);
+	if (is_case_break(*tokens) || is_reserved(*tokens, "esac"))
+		vm_emit(prog, VOP_STATUS, 0);
+	else if (!emit_list(prog, tokens))
+		return (0);
+	*done = vm_emit(prog, VOP_JUMP, *done);
+	vm_patch(prog, skip);
+	skip_newlines(tokens);
+	if (is_case_break(*tokens))
+		*tokens = (*tokens)->next->next;
+	skip_newlines(tokens);
+	return (1);
+}
+
+// case word in item... esac. No match leaves $? at 0.
+static int	parse_case(t_vm_prog *prog, t_token **tokens)
+{
+	int	slot;
+	int	done;
+
+	*tokens = (*tokens)->next;
+	slot = prog->slots++;
+	if (emit_word(prog, tokens, VOP_CASE_WORD, slot) < 0
+		|| !expect(tokens, "in"))
+		return (0);
+	skip_newlines(tokens);
+	done = -1;
+	while (*tokens && !is_reserved(*tokens, "esac"))
+	{
+		if (!parse_case_item(prog, tokens, slot, &done))
+			return (0);
+	}
+	vm_patch_chain(prog, done);
+	return (expect(tokens, "esac"));
+}
+
+// A compound command at *tokens and the redirections after it
+t_command	*parse_compound(t_token **tokens)
+{
+	t_command	*cmd;
+	t_vm_prog	*prog;
+	int		ok;
+
+	prog = vm_new();
+	cmd = create_command(CMD_COMPOUND);
+	if (!cmd || !prog)
+	{
+		free(cmd);
+		vm_release(prog);
+		return (NULL);
+	}
+	cmd->data.compound.prog = prog;
+	parser_nest(1);
+	if (is_reserved(*tokens, "if"))
+		ok = parse_if(prog, tokens);
+	else if (is_reserved(*tokens, "for"))
+		ok = parse_for(prog, tokens);
+	else if (is_reserved(*tokens, "case"))
+		ok = parse_case(prog, tokens);
+	else
+		ok = parse_while(prog, tokens);
+	parser_nest(-1);
+	if (!ok || prog->failed
+		|| !parse_group_redirs(tokens, &cmd->data.compound.redirs))
+	{
+		free_command(cmd);
+		return (NULL);
+	}
+	return (cmd);
+}
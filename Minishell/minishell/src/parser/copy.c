@@ -0,0 +1,145 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   copy.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 19:41:27 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 19:41:29 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "parser.h"
+#include "vm.h"
+
+// Deep copies of command trees, for definitions that must outlive the
+// line they were parsed from (function bodies)
+
+static t_redir	*copy_redirs(t_redir *redirs, int *ok)
+{
+	t_redir	*head;
+	t_redir	**tail;
+
+	head = NULL;
+	tail = &head;
+	while (redirs && *ok)
+	{
+		*tail = malloc(sizeof(t_redir));
+		if (!*tail)
+			break ;
+		**tail = *redirs;
+		(*tail)->next = NULL;
+		(*tail)->file = ft_strdup(redirs->file);
+		if (redirs->body)
+			(*tail)->body = ft_strdup(redirs->body);
+		if (!(*tail)->file || (redirs->body && !(*tail)->body))
+		{
+			free((*tail)->file);
+			free((*tail)->body);
+			free(*tail);
+			*tail = NULL;
+			break ;
+		}
+		tail = &(*tail)->next;
+		redirs = redirs->next;
+	}
+	if (redirs)
+		*ok = 0;
+	return (head);
+}
+
+static char	**copy_args(char **args, int *ok)
+{
+	char	**copy;
+	int	n;
+
+	if (!args)
+		return (NULL);
+	n = 0;
+	while (args[n])
+		n++;
+	copy = malloc(sizeof(char *) * (n + 1));
+	if (!copy)
+	{
+		*ok = 0;
+		return (NULL);
+	}
+	copy[n] = NULL;
+	while (n-- > 0)
+	{
+		copy[n] = ft_strdup(args[n]);
+		if (!copy[n])
+		{
+			while (copy[++n])
+				free(copy[n]);
+			free(copy);
+			*ok = 0;
+			return (NULL);
+		}
+	}
+	return (copy);
+}
+
+static void	copy_node(t_command *copy, t_command *cmd, int *ok)
+{
+	if (cmd->type == CMD_SIMPLE)
+	{
+		copy->data.simple.args = copy_args(cmd->data.simple.args, ok);
+		copy->data.simple.redirs = copy_redirs(cmd->data.simple.redirs, ok);
+		copy->data.simple.assigns = copy_args(cmd->data.simple.assigns, ok);
+	}
+	else if (cmd->type == CMD_SUBSHELL || cmd->type == CMD_GROUP)
+	{
+		copy->data.subshell.body = copy_command(cmd->data.subshell.body);
+		copy->data.subshell.redirs = copy_redirs(cmd->data.subshell.redirs,
+				ok);
+		*ok = *ok && copy->data.subshell.body;
+	}
+	else if (cmd->type == CMD_COMPOUND)
+	{
+		// Compiled programs are immutable: share it
+		copy->data.compound.prog = cmd->data.compound.prog;
+		copy->data.compound.prog->refs++;
+		copy->data.compound.redirs = copy_redirs(cmd->data.compound.redirs,
+				ok);
+	}
+	else if (cmd->type == CMD_FUNCDEF)
+	{
+		copy->data.funcdef.name = ft_strdup(cmd->data.funcdef.name);
+		copy->data.funcdef.body = copy_command(cmd->data.funcdef.body);
+		*ok = copy->data.funcdef.name && copy->data.funcdef.body;
+	}
+	else
+	{
+		// CMD_PIPE and CMD_LIST: pipe_cmd has the layout of list
+		copy->data.list.left = copy_command(cmd->data.list.left);
+		copy->data.list.right = copy_command(cmd->data.list.right);
+		*ok = copy->data.list.left && copy->data.list.right;
+		if (cmd->type == CMD_PIPE)
+			copy->data.pipe_cmd.feed = cmd->data.pipe_cmd.feed;
+	}
+}
+
+// A copy of cmd sharing nothing with it, or NULL
+t_command	*copy_command(t_command *cmd)
+{
+	t_command	*copy;
+	int		ok;
+
+	if (!cmd)
+		return (NULL);
+	copy = malloc(sizeof(t_command));
+	if (!copy)
+		return (NULL);
+	ft_bzero(copy, sizeof(t_command));
+	copy->type = cmd->type;
+	ok = 1;
+	copy_node(copy, cmd, &ok);
+	if (!ok)
+	{
+		free_command(copy);
+		return (NULL);
+	}
+	return (copy);
+}
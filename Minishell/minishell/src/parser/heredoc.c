@@ -0,0 +1,136 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   heredoc.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 10:12:40 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 10:12:42 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "parser.h"
+#include "expander.h"
+#include "history.h"
+
+// Here-document bodies. They are read from the input right after the
+// line holding their `<<`, as that line is parsed, and handed to the
+// redirections in order; running the command then only replays the
+// text. A loop or a function runs the same body every time instead of
+// reading the lines after it again.
+
+typedef struct s_heredocs
+{
+	char	**bodies;
+	int	count;
+	int	cap;
+	int	next;	// the one the next `<<` parsed gets
+}	t_heredocs;
+
+static t_heredocs	g_docs;
+
+// Lines of input up to delim, each with its newline, as one string.
+// NULL when out of memory or when Ctrl-C ends the input.
+static char	*read_body(const char *delim)
+{
+	char	*body;
+	char	*line;
+	char	*joined;
+	size_t	len;
+
+	body = ft_strdup("");
+	len = ft_strlen(delim) + 1;
+	while (body)
+	{
+		line = input_line("> ");
+		if (g_sig == SIGINT)
+		{
+			free(line);
+			free(body);
+			return (NULL);
+		}
+		if (!line || ft_strncmp(line, delim, len) == 0)
+		{
+			free(line);
+			break ;
+		}
+		joined = ft_strjoin(body, line);
+		free(body);
+		free(line);
+		body = NULL;
+		if (joined)
+			body = ft_strjoin(joined, "\n");
+		free(joined);
+	}
+	return (body);
+}
+
+static int	keep(char *body)
+{
+	char	**grown;
+
+	if (!body)
+		return (0);
+	if (g_docs.count == g_docs.cap)
+	{
+		g_docs.cap = g_docs.cap * 2 + 4;
+		grown = malloc(sizeof(char *) * g_docs.cap);
+		if (!grown)
+		{
+			free(body);
+			return (0);
+		}
+		if (g_docs.bodies)
+			ft_memcpy(grown, g_docs.bodies, sizeof(char *) * g_docs.count);
+		free(g_docs.bodies);
+		g_docs.bodies = grown;
+	}
+	g_docs.bodies[g_docs.count++] = body;
+	return (1);
+}
+
+// Read the bodies of the heredocs in tokens that have none yet: those
+// on the line just added to the command. 0 when out of memory or
+// interrupted.
+int	heredoc_collect(t_token *tokens)
+{
+	char	*delim;
+	int	n;
+
+	n = 0;
+	while (tokens)
+	{
+		if (tokens->type == TOKEN_HEREDOC && tokens->next
+			&& tokens->next->type == TOKEN_WORD && n++ >= g_docs.count)
+		{
+			delim = remove_quotes(tokens->next->value);
+			if (!delim || !keep(read_body(delim)))
+			{
+				free(delim);
+				return (0);
+			}
+			free(delim);
+		}
+		tokens = tokens->next;
+	}
+	g_docs.next = 0;
+	return (1);
+}
+
+// Body for the next `<<` of the command being parsed, as a new string.
+// Commands parsed from text, such as a substitution, have none.
+char	*heredoc_take(void)
+{
+	if (g_docs.next < g_docs.count)
+		return (ft_strdup(g_docs.bodies[g_docs.next++]));
+	return (ft_strdup(""));
+}
+
+// The command is parsed: forget its bodies
+void	heredoc_clear(void)
+{
+	while (g_docs.count > 0)
+		free(g_docs.bodies[--g_docs.count]);
+	g_docs.next = 0;
+}
@@ -12,6 +12,18 @@
 
 #include "parser.h"
 
+// Open constructs (groups, compound commands) around the parse position.
+// Running out of tokens inside one means the command goes on in the
+// next line when the caller asked to know (parse_input).
+typedef struct s_parse_state
+{
+	int	depth;
+	int	want_more;	// report an open construct instead of an error
+	int	incomplete;
+}	t_parse_state;
+
+static t_parse_state	g_parse;
+
 static t_redir	*create_redir(t_redir_type type, char *file)
 {
 	t_redir	*redir;
@@ -20,9 +32,15 @@ static t_redir	*create_redir(t_redir_type type, char *file)
 	if (!redir)
 		return (NULL);
 	redir->type = type;
+	redir->fd = -1;
 	redir->file = ft_strdup(file);
-	if (!redir->file)
+	redir->body = NULL;
+	if (type == REDIR_HEREDOC)
+		redir->body = heredoc_take();
+	if (!redir->file || (type == REDIR_HEREDOC && !redir->body))
 	{
+		free(redir->file);
+		free(redir->body);
 		free(redir);
 		return (NULL);
 	}
@@ -45,22 +63,154 @@ static void	add_redir(t_redir **redirs, t_redir *new_redir)
 	current->next = new_redir;
 }
 
-static t_simple_cmd	parse_simple_cmd(t_token **tokens)
+void	parser_nest(int delta)
+{
+	g_parse.depth += delta;
+}
+
+void	syntax_error(t_token *token)
+{
+	if (!token && g_parse.depth > 0 && g_parse.want_more)
+	{
+		g_parse.incomplete = 1;
+		return ;
+	}
+	if (token && is_newline(token))
+		token = NULL;
+	if (token)
+		fprintf(stderr, "minishell: syntax error near unexpected token `%s'\n",
+			token->value);
+	else
+		fprintf(stderr,
+			"minishell: syntax error near unexpected token `newline'\n");
+	get_shell()->last_status = 2;
+}
+
+static int	is_redirect_token(t_token *token)
+{
+	return (token && (token->type == TOKEN_REDIRECT_IN
+			|| token->type == TOKEN_REDIRECT_OUT
+			|| token->type == TOKEN_HEREDOC
+			|| token->type == TOKEN_APPEND
+			|| token->type == TOKEN_REDIRECT_RDWR
+			|| token->type == TOKEN_CLOBBER
+			|| token->type == TOKEN_DUP_IN
+			|| token->type == TOKEN_DUP_OUT));
+}
+
+static t_redir_type	redir_type_of(t_token_type type)
+{
+	if (type == TOKEN_REDIRECT_IN)
+		return (REDIR_IN);
+	if (type == TOKEN_REDIRECT_OUT)
+		return (REDIR_OUT);
+	if (type == TOKEN_HEREDOC)
+		return (REDIR_HEREDOC);
+	if (type == TOKEN_APPEND)
+		return (REDIR_APPEND);
+	if (type == TOKEN_REDIRECT_RDWR)
+		return (REDIR_RDWR);
+	if (type == TOKEN_CLOBBER)
+		return (REDIR_CLOBBER);
+	return (REDIR_DUP);
+}
+
+// fd a redirection applies to when no number is written before it
+static int	default_redir_fd(t_token_type type)
+{
+	if (type == TOKEN_REDIRECT_IN || type == TOKEN_HEREDOC
+		|| type == TOKEN_REDIRECT_RDWR || type == TOKEN_DUP_IN)
+		return (STDIN_FILENO);
+	return (STDOUT_FILENO);
+}
+
+// Consume one "[n]<op> WORD" pair. Returns 0 on a syntax error.
+static int	parse_redirect(t_token **tokens, t_redir **redirs)
+{
+	t_redir		*redir;
+	t_token		*op;
+
+	op = *tokens;
+	*tokens = (*tokens)->next;
+	if (!*tokens || (*tokens)->type != TOKEN_WORD)
+	{
+		syntax_error(*tokens);
+		return (0);
+	}
+	redir = create_redir(redir_type_of(op->type), (*tokens)->value);
+	if (redir)
+	{
+		redir->fd = op->io_number;
+		if (redir->fd < 0)
+			redir->fd = default_redir_fd(op->type);
+		add_redir(redirs, redir);
+	}
+	*tokens = (*tokens)->next;
+	return (1);
+}
+
+// NAME=value, with NAME written out plainly
+int	is_assignment(const char *word)
+{
+	int	i;
+
+	if (!ft_isalpha(word[0]) && word[0] != '_')
+		return (0);
+	i = 1;
+	while (ft_isalnum(word[i]) || word[i] == '_')
+		i++;
+	return (word[i] == '=');
+}
+
+// Move the assignments that start cmd->args to cmd->assigns. Words
+// after the command name are arguments, whatever they look like.
+static int	split_assigns(t_simple_cmd *cmd)
+{
+	int	n;
+	int	i;
+
+	n = 0;
+	while (cmd->args[n] && is_assignment(cmd->args[n]))
+		n++;
+	if (n == 0)
+		return (1);
+	cmd->assigns = malloc(sizeof(char *) * (n + 1));
+	if (!cmd->assigns)
+		return (0);
+	ft_memcpy(cmd->assigns, cmd->args, sizeof(char *) * n);
+	cmd->assigns[n] = NULL;
+	i = 0;
+	while (cmd->args[n + i])
+	{
+		cmd->args[i] = cmd->args[n + i];
+		i++;
+	}
+	cmd->args[i] = NULL;
+	if (i == 0)
+	{
+		free(cmd->args);
+		cmd->args = NULL;
+	}
+	return (1);
+}
+
+static int	parse_simple_cmd(t_token **tokens, t_simple_cmd *out)
 {
     t_simple_cmd	cmd;
-    t_redir		*redir;
-    t_redir_type	redir_type;
 
     // Temporary arg linked list
     typedef struct s_arg { char *v; struct s_arg *next; } t_arg;
     t_arg	*args_head = NULL;
     t_arg	*args_tail = NULL;
     int		argc = 0;
+    int		ok = 1;
 
     cmd.args = NULL;
     cmd.redirs = NULL;
+    cmd.assigns = NULL;
 
-    while (*tokens && (*tokens)->type != TOKEN_PIPE)
+    while (*tokens && ((*tokens)->type == TOKEN_WORD
+            || is_redirect_token(*tokens)))
     {
         if ((*tokens)->type == TOKEN_WORD)
         {
@@ -82,37 +232,20 @@ static t_simple_cmd	parse_simple_cmd(t_token **tokens)
             argc++;
             *tokens = (*tokens)->next;
         }
-        else if ((*tokens)->type == TOKEN_REDIRECT_IN ||
-                 (*tokens)->type == TOKEN_REDIRECT_OUT ||
-                 (*tokens)->type == TOKEN_HEREDOC ||
-                 (*tokens)->type == TOKEN_APPEND)
-        {
-            if ((*tokens)->type == TOKEN_REDIRECT_IN)
-                redir_type = REDIR_IN;
-            else if ((*tokens)->type == TOKEN_REDIRECT_OUT)
-                redir_type = REDIR_OUT;
-            else if ((*tokens)->type == TOKEN_HEREDOC)
-                redir_type = REDIR_HEREDOC;
-            else
-                redir_type = REDIR_APPEND;
-
-            *tokens = (*tokens)->next;
-            if (*tokens && (*tokens)->type == TOKEN_WORD)
-            {
-                redir = create_redir(redir_type, (*tokens)->value);
-                if (redir)
-                    add_redir(&cmd.redirs, redir);
-                *tokens = (*tokens)->next;
-            }
-        }
-        else
+        else if (!parse_redirect(tokens, &cmd.redirs))
         {
-            // Unknown token type for a simple command; stop
+            ok = 0;
             break ;
         }
     }
+    if (ok && argc == 0 && !cmd.redirs)
+    {
+        // Nothing usable before an operator: `| ls`, `;`, `)` ...
+        syntax_error(*tokens);
+        ok = 0;
+    }
 
-    if (argc > 0)
+    if (ok && argc > 0)
     {
         cmd.args = malloc(sizeof(char *) * (argc + 1));
         if (cmd.args)
@@ -127,12 +260,16 @@ static t_simple_cmd	parse_simple_cmd(t_token **tokens)
                 it = next;
             }
             cmd.args[i] = NULL;
+            args_head = NULL; // the words now belong to cmd.args
+            ok = split_assigns(&cmd);
         }
+        else
+            ok = 0;
     }
     // If no args collected, leave cmd.args == NULL
 
-    // Free any remaining arg nodes on allocation failure
-    if (!cmd.args && args_head)
+    // Free any remaining arg nodes on failure
+    if (args_head)
     {
         t_arg *it = args_head;
         while (it)
@@ -143,41 +280,201 @@ static t_simple_cmd	parse_simple_cmd(t_token **tokens)
             it = next;
         }
     }
-
-    return (cmd);
+    if (!ok)
+    {
+        if (cmd.args)
+        {
+            int i = 0;
+            while (cmd.args[i])
+                free(cmd.args[i++]);
+            free(cmd.args);
+        }
+        free_redirs(cmd.redirs);
+        return (0);
+    }
+    *out = cmd;
+    return (1);
 }
 
-static t_command	*create_command(t_command_type type)
+t_command	*create_command(t_command_type type)
 {
 	t_command	*cmd;
 
 	cmd = malloc(sizeof(t_command));
 	if (!cmd)
 		return (NULL);
+	ft_bzero(cmd, sizeof(t_command));
 	cmd->type = type;
 	return (cmd);
 }
 
-t_command	*parse(t_token *tokens)
+// An unquoted reserved word like `{` or `}`
+int	is_reserved(t_token *token, const char *word)
+{
+	return (token && token->type == TOKEN_WORD
+		&& ft_strncmp(token->value, word, ft_strlen(word) + 1) == 0);
+}
+
+// A line break, which separates commands like `;`
+int	is_newline(t_token *token)
+{
+	return (token && token->type == TOKEN_SEMICOLON
+		&& token->value[0] == '\n');
+}
+
+void	skip_newlines(t_token **tokens)
+{
+	while (is_newline(*tokens))
+		*tokens = (*tokens)->next;
+}
+
+// `;;` ends a case item
+int	is_case_break(t_token *token)
+{
+	return (token && token->type == TOKEN_SEMICOLON && !is_newline(token)
+		&& token->next && token->next->type == TOKEN_SEMICOLON
+		&& !is_newline(token->next));
+}
+
+// Reserved words that close a list, and so cannot start a command
+static int	ends_list(t_token *token)
+{
+	static const char	*words[] = {"}", "then", "elif", "else", "fi",
+		"do", "done", "esac", NULL};
+	int			i;
+
+	if (!token)
+		return (1);
+	if (token->type == TOKEN_RPAREN || is_case_break(token))
+		return (1);
+	i = 0;
+	while (words[i] && !is_reserved(token, words[i]))
+		i++;
+	return (words[i] != NULL);
+}
+
+// Redirections after `( list )` or `{ list; }`; nothing else may follow
+int	parse_group_redirs(t_token **tokens, t_redir **redirs)
+{
+	while (is_redirect_token(*tokens))
+	{
+		if (!parse_redirect(tokens, redirs))
+			return (0);
+	}
+	if (*tokens && ((*tokens)->type == TOKEN_WORD
+			|| (*tokens)->type == TOKEN_LPAREN))
+	{
+		syntax_error(*tokens);
+		return (0);
+	}
+	return (1);
+}
+
+// '(' list ')' or '{' list '}' followed by any number of redirections
+static t_command	*parse_subshell(t_token **tokens)
+{
+	t_command	*cmd;
+	int		brace;
+
+	brace = is_reserved(*tokens, "{");
+	*tokens = (*tokens)->next;
+	cmd = create_command(brace ? CMD_GROUP : CMD_SUBSHELL);
+	if (!cmd)
+		return (NULL);
+	parser_nest(1);
+	cmd->data.subshell.body = parse_list(tokens);
+	parser_nest(-1);
+	if (!cmd->data.subshell.body)
+	{
+		free(cmd);
+		return (NULL);
+	}
+	if (brace ? !is_reserved(*tokens, "}")
+		: (!*tokens || (*tokens)->type != TOKEN_RPAREN))
+	{
+		syntax_error(*tokens);
+		free_command(cmd);
+		return (NULL);
+	}
+	*tokens = (*tokens)->next;
+	if (!parse_group_redirs(tokens, &cmd->data.subshell.redirs))
+	{
+		free_command(cmd);
+		return (NULL);
+	}
+	return (cmd);
+}
+
+// name '(' ')' followed by a `{ ... }` or `( ... )` body
+static t_command	*parse_funcdef(t_token **tokens)
+{
+	t_command	*cmd;
+
+	cmd = create_command(CMD_FUNCDEF);
+	if (!cmd)
+		return (NULL);
+	cmd->data.funcdef.name = ft_strdup((*tokens)->value);
+	*tokens = (*tokens)->next->next->next;
+	if (!is_reserved(*tokens, "{")
+		&& (!*tokens || (*tokens)->type != TOKEN_LPAREN))
+	{
+		syntax_error(*tokens);
+		free_command(cmd);
+		return (NULL);
+	}
+	cmd->data.funcdef.body = parse_subshell(tokens);
+	if (!cmd->data.funcdef.name || !cmd->data.funcdef.body)
+	{
+		free_command(cmd);
+		return (NULL);
+	}
+	return (cmd);
+}
+
+static int	is_funcdef(t_token *token)
+{
+	return (token->type == TOKEN_WORD && token->next
+		&& token->next->type == TOKEN_LPAREN && token->next->next
+		&& token->next->next->type == TOKEN_RPAREN);
+}
+
+static t_command	*parse_pipeline(t_token **tokens)
 {
 	t_command	*cmd;
 	t_command	*left;
 	t_command	*right;
 
-	if (!tokens)
+	if (*tokens && ((*tokens)->type == TOKEN_LPAREN
+			|| is_reserved(*tokens, "{")))
+		cmd = parse_subshell(tokens);
+	else if (is_compound_start(*tokens))
+		cmd = parse_compound(tokens);
+	else if (*tokens && ends_list(*tokens))
+	{
+		syntax_error(*tokens);
 		return (NULL);
-	
-	cmd = create_command(CMD_SIMPLE);
+	}
+	else if (*tokens && is_funcdef(*tokens))
+		cmd = parse_funcdef(tokens);
+	else
+	{
+		cmd = create_command(CMD_SIMPLE);
+		if (!cmd)
+			return (NULL);
+		if (!parse_simple_cmd(tokens, &cmd->data.simple))
+		{
+			free(cmd);
+			return (NULL);
+		}
+	}
 	if (!cmd)
 		return (NULL);
 	
-	cmd->data.simple = parse_simple_cmd(&tokens);
-	
-	if (tokens && tokens->type == TOKEN_PIPE)
+	if (*tokens && (*tokens)->type == TOKEN_PIPE)
 	{
 		left = cmd;
-		tokens = tokens->next;
-		right = parse(tokens);
+		*tokens = (*tokens)->next;
+		right = parse_pipeline(tokens);
 		if (!right)
 		{
 			free_command(left);
@@ -196,3 +493,73 @@ t_command	*parse(t_token *tokens)
 	
 	return (cmd);
 }
+
+// pipeline { ';' pipeline } [ ';' ], ending before a ')', a `;;` or
+// a reserved word that closes the construct the list is in. Line
+// breaks separate commands like `;` and may come before the list.
+t_command	*parse_list(t_token **tokens)
+{
+	t_command	*cmd;
+	t_command	*right;
+	t_command	*seq;
+
+	skip_newlines(tokens);
+	cmd = parse_pipeline(tokens);
+	if (!cmd)
+		return (NULL);
+	if (!*tokens || (*tokens)->type != TOKEN_SEMICOLON
+		|| is_case_break(*tokens))
+		return (cmd);
+	*tokens = (*tokens)->next;
+	skip_newlines(tokens);
+	if (ends_list(*tokens))
+		return (cmd);
+	right = parse_list(tokens);
+	if (!right)
+	{
+		free_command(cmd);
+		return (NULL);
+	}
+	seq = create_command(CMD_LIST);
+	if (!seq)
+	{
+		free_command(cmd);
+		free_command(right);
+		return (NULL);
+	}
+	seq->data.list.left = cmd;
+	seq->data.list.right = right;
+	return (seq);
+}
+
+// Parse a whole line. When incomplete is given, a line that ends
+// inside a group or compound command sets it instead of reporting a
+// syntax error, so that the caller can read the rest.
+t_command	*parse_input(t_token *tokens, int *incomplete)
+{
+	t_command	*cmd;
+
+	g_parse.depth = 0;
+	g_parse.want_more = (incomplete != NULL);
+	g_parse.incomplete = 0;
+	if (incomplete)
+		*incomplete = 0;
+	if (!tokens)
+		return (NULL);
+	cmd = parse_list(&tokens);
+	if (cmd && tokens)
+	{
+		// Leftover tokens, e.g. an unmatched ')'
+		syntax_error(tokens);
+		free_command(cmd);
+		return (NULL);
+	}
+	if (incomplete)
+		*incomplete = g_parse.incomplete;
+	return (cmd);
+}
+
+t_command	*parse(t_token *tokens)
+{
+	return (parse_input(tokens, NULL));
+}
@@ -17,12 +17,16 @@
 
 void	handle_sigint(int sig)
 {
-	(void)sig;
-	/* Move to new line and clear current readline buffer */
-	write(1, "\n", 1);
-	rl_on_new_line();
+	g_sig = sig; // seen by loops that run no child to take the signal
+	if (!get_shell()->reading)
+	{
+		write(1, "\n", 1);
+		return ;
+	}
+	/* Drop the line being edited and have readline return it: it
+	   moves to a new line itself, and the caller prompts again */
 	rl_replace_line("", 0);
-	rl_redisplay();
+	rl_done = 1;
 }
 
 void	setup_signals(void)
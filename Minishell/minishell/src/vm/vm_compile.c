@@ -0,0 +1,254 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   vm_compile.c                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 21:31:07 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 21:31:09 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "vm.h"
+#include "builtins.h"
+
+// Building t_vm_prog. Lists are flattened into the instruction stream;
+// a compound command inside another is spliced in, so a whole nest of
+// loops and ifs is one program. Simple commands naming a builtin are
+// resolved here, once, instead of on every run.
+
+t_vm_prog	*vm_new(void)
+{
+	t_vm_prog	*prog;
+
+	prog = ft_calloc(1, sizeof(t_vm_prog));
+	if (prog)
+		prog->refs = 1;
+	return (prog);
+}
+
+static void	free_words(char **words)
+{
+	int	i;
+
+	i = 0;
+	while (words && words[i])
+		free(words[i++]);
+	free(words);
+}
+
+void	vm_release(t_vm_prog *prog)
+{
+	int	i;
+
+	if (!prog || --prog->refs > 0)
+		return ;
+	i = 0;
+	while (i < prog->len)
+	{
+		free_command(prog->code[i].cmd);
+		free_words(prog->code[i].words);
+		free(prog->code[i].name);
+		i++;
+	}
+	free(prog->code);
+	free(prog);
+}
+
+// Append an instruction; its index, or -1 (and prog->failed) when out
+// of memory
+int	vm_emit(t_vm_prog *prog, int op, int arg)
+{
+	t_vm_insn	*grown;
+
+	if (prog->failed)
+		return (-1);
+	if (prog->len == prog->cap)
+	{
+		prog->cap = prog->cap ? prog->cap * 2 : 16;
+		grown = malloc(sizeof(t_vm_insn) * prog->cap);
+		if (!grown)
+		{
+			prog->failed = 1;
+			return (-1);
+		}
+		if (prog->code)
+			ft_memcpy(grown, prog->code, sizeof(t_vm_insn) * prog->len);
+		free(prog->code);
+		prog->code = grown;
+	}
+	ft_bzero(&prog->code[prog->len], sizeof(t_vm_insn));
+	prog->code[prog->len].op = op;
+	prog->code[prog->len].arg = arg;
+	return (prog->len++);
+}
+
+// Point the jump at `at` to the next instruction
+void	vm_patch(t_vm_prog *prog, int at)
+{
+	if (at >= 0 && !prog->failed)
+		prog->code[at].arg = prog->len;
+}
+
+// Patch every jump of a chain linked through arg, ending at -1
+void	vm_patch_chain(t_vm_prog *prog, int head)
+{
+	int	next;
+
+	while (head >= 0 && !prog->failed)
+	{
+		next = prog->code[head].arg;
+		prog->code[head].arg = prog->len;
+		head = next;
+	}
+}
+
+// Resolve the break/continue in code[from..] that leave this loop: break
+// goes past it, continue back to top. Those for outer loops count one
+// loop less.
+void	vm_close_loop(t_vm_prog *prog, int from, int top)
+{
+	t_vm_insn	*insn;
+
+	while (!prog->failed && from < prog->len)
+	{
+		insn = &prog->code[from++];
+		if ((insn->op != VOP_BREAK && insn->op != VOP_CONTINUE)
+			|| insn->arg >= 0)
+			continue ;
+		if (insn->levels > 1)
+			insn->levels--;
+		else if (insn->op == VOP_BREAK)
+			insn->arg = prog->len;
+		else
+			insn->arg = top;
+	}
+}
+
+// Move the instructions of child to the end of prog, renumbering its
+// jump targets and slots. child is consumed.
+static int	splice(t_vm_prog *prog, t_vm_prog *child)
+{
+	t_vm_insn	*insn;
+	int		base;
+	int		i;
+
+	base = prog->len;
+	i = 0;
+	while (i < child->len && vm_emit(prog, 0, 0) >= 0)
+	{
+		insn = &prog->code[base + i];
+		*insn = child->code[i];
+		if (insn->op == VOP_JUMP || insn->op == VOP_JUMP_OK
+			|| insn->op == VOP_JUMP_FAIL || insn->op == VOP_FOR_NEXT
+			|| insn->op == VOP_CASE_MATCH || ((insn->op == VOP_BREAK
+					|| insn->op == VOP_CONTINUE) && insn->arg >= 0))
+			insn->arg += base;
+		insn->slot += prog->slots;
+		ft_bzero(&child->code[i++], sizeof(t_vm_insn));
+	}
+	prog->slots += child->slots;
+	vm_release(child);
+	return (!prog->failed);
+}
+
+// Whether raw is written as plain text, so that it is what the command
+// name will expand to
+static int	is_literal(const char *raw)
+{
+	while (*raw)
+	{
+		if (ft_strchr("$'\"\\*?[{~", *raw))
+			return (0);
+		raw++;
+	}
+	return (1);
+}
+
+// `break [n]` or `continue [n]` written out with a literal count
+static int	loop_control(t_simple_cmd *cmd)
+{
+	char	**args;
+	int	i;
+
+	args = cmd->args;
+	if (cmd->redirs || !args || (ft_strncmp(args[0], "break", 6) != 0
+			&& ft_strncmp(args[0], "continue", 9) != 0))
+		return (0);
+	if (!args[1])
+		return (1);
+	i = 0;
+	while (ft_isdigit(args[1][i]))
+		i++;
+	if (args[2] || i == 0 || i > 9 || args[1][i] || ft_atoi(args[1]) < 1)
+		return (0);
+	return (ft_atoi(args[1]));
+}
+
+static int	emit_simple(t_vm_prog *prog, t_command *cmd)
+{
+	int	levels;
+	int	builtin;
+	int	at;
+
+	levels = loop_control(&cmd->data.simple);
+	if (levels)
+	{
+		at = vm_emit(prog, cmd->data.simple.args[0][0] == 'b'
+				? VOP_BREAK : VOP_CONTINUE, -1);
+		if (at >= 0)
+			prog->code[at].levels = levels;
+		free_command(cmd);
+		return (at >= 0);
+	}
+	builtin = -1;
+	if (cmd->data.simple.args && is_literal(cmd->data.simple.args[0]))
+		builtin = builtin_id(cmd->data.simple.args[0]);
+	at = vm_emit(prog, builtin >= 0 ? VOP_BUILTIN : VOP_RUN, builtin);
+	if (at < 0)
+	{
+		free_command(cmd);
+		return (0);
+	}
+	prog->code[at].cmd = cmd;
+	return (1);
+}
+
+// Lower cmd into prog, which takes it over
+int	vm_emit_command(t_vm_prog *prog, t_command *cmd)
+{
+	int	ok;
+	int	at;
+
+	if (cmd->type == CMD_SIMPLE)
+		return (emit_simple(prog, cmd));
+	if (cmd->type == CMD_LIST)
+	{
+		ok = vm_emit_command(prog, cmd->data.list.left);
+		ok = vm_emit_command(prog, cmd->data.list.right) && ok;
+		free(cmd);
+		return (ok);
+	}
+	if (cmd->type == CMD_GROUP && !cmd->data.subshell.redirs)
+	{
+		ok = vm_emit_command(prog, cmd->data.subshell.body);
+		free(cmd);
+		return (ok);
+	}
+	if (cmd->type == CMD_COMPOUND && !cmd->data.compound.redirs
+		&& cmd->data.compound.prog->refs == 1)
+	{
+		ok = splice(prog, cmd->data.compound.prog);
+		free(cmd);
+		return (ok);
+	}
+	at = vm_emit(prog, VOP_RUN, 0);
+	if (at < 0)
+	{
+		free_command(cmd);
+		return (0);
+	}
+	prog->code[at].cmd = cmd;
+	return (1);
+}
@@ -0,0 +1,153 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   vm_run.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: isel-bar <isel-bar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/10/19 21:48:36 by isel-bar          #+#    #+#             */
+/*   Updated: 2026/10/19 21:48:38 by isel-bar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "vm.h"
+#include "executor.h"
+#include "expander.h"
+
+// The dispatch loop. $? lives in shell->last_status, where expansions
+// read it; loop and case state lives in a frame of slots allocated per
+// run, so a function that recurses into the same program is safe.
+
+static void	clear_slot(t_vm_slot *slot)
+{
+	int	i;
+
+	i = 0;
+	while (slot->words && slot->words[i])
+		free(slot->words[i++]);
+	free(slot->words);
+	free(slot->subject);
+	ft_bzero(slot, sizeof(t_vm_slot));
+}
+
+static void	loop_init(t_vm_insn *insn, t_vm_slot *slot, t_env *env)
+{
+	t_shell	*shell;
+
+	shell = get_shell();
+	clear_slot(slot);
+	if (insn->words)
+	{
+		slot->words = expand_args(insn->words, env, shell->last_status);
+		if (!slot->words)
+			shell->last_status = 1;
+	}
+}
+
+// Assign the next word of a for loop; 0 when there is none left
+static int	for_next(t_vm_insn *insn, t_vm_slot *slot, t_env *env)
+{
+	if (!slot->words || !slot->words[slot->next])
+		return (0);
+	set_env_value(&env, insn->name, slot->words[slot->next++]);
+	return (1);
+}
+
+static int	case_match(t_vm_insn *insn, t_vm_slot *slot, t_env *env)
+{
+	char	*pattern;
+	int	match;
+
+	if (!slot->subject)
+		return (0);
+	pattern = expand_pattern(insn->words[0], env, get_shell()->last_status);
+	if (!pattern)
+		return (0);
+	match = pattern_match(pattern, slot->subject, ft_strlen(slot->subject));
+	free(pattern);
+	return (match);
+}
+
+// break/continue left unresolved by the compiler: no enclosing loop
+// in this program
+static int	loop_control(t_vm_insn *insn, int pc)
+{
+	get_shell()->last_status = 0;
+	if (insn->arg >= 0)
+		return (insn->arg);
+	fprintf(stderr, "minishell: %s: only meaningful in a `for', `while', "
+		"or `until' loop\n", insn->op == VOP_BREAK ? "break" : "continue");
+	return (pc + 1);
+}
+
+// Run insn; returns the next pc
+static int	step(t_vm_insn *insn, int pc, t_vm_slot *slots, t_env *env)
+{
+	t_shell	*shell;
+	int	status;
+
+	shell = get_shell();
+	status = shell->last_status;
+	if (insn->op == VOP_BUILTIN)
+		execute_builtin_command(&insn->cmd->data.simple, insn->arg, env);
+	else if (insn->op == VOP_RUN)
+		execute_command(insn->cmd, env);
+	else if (insn->op == VOP_JUMP || (insn->op == VOP_JUMP_OK && status == 0)
+		|| (insn->op == VOP_JUMP_FAIL && status != 0))
+		return (insn->arg);
+	else if (insn->op == VOP_STATUS)
+		shell->last_status = insn->arg;
+	else if (insn->op == VOP_LOOP_INIT)
+		loop_init(insn, &slots[insn->slot], env);
+	else if (insn->op == VOP_FOR_NEXT && !for_next(insn, &slots[insn->slot],
+			env))
+		return (insn->arg);
+	else if (insn->op == VOP_SAVE)
+		slots[insn->slot].status = status;
+	else if (insn->op == VOP_RESTORE)
+		shell->last_status = slots[insn->slot].status;
+	else if (insn->op == VOP_CASE_WORD)
+	{
+		free(slots[insn->slot].subject);
+		slots[insn->slot].subject = expand_word(insn->words[0], env, status);
+		shell->last_status = 0;
+	}
+	else if (insn->op == VOP_CASE_MATCH
+		&& case_match(insn, &slots[insn->slot], env))
+		return (insn->arg);
+	else if (insn->op == VOP_BREAK || insn->op == VOP_CONTINUE)
+		return (loop_control(insn, pc));
+	return (pc + 1);
+}
+
+int	vm_run(t_vm_prog *prog, t_env *env)
+{
+	t_vm_slot	*slots;
+	t_shell		*shell;
+	int		next;
+	int		pc;
+
+	shell = get_shell();
+	slots = ft_calloc(prog->slots + 1, sizeof(t_vm_slot));
+	if (!slots)
+		return (1);
+	prog->refs++;
+	pc = 0;
+	while (pc < prog->len && !shell->returning)
+	{
+		next = step(&prog->code[pc], pc, slots, env);
+		if (next <= pc && g_sig == SIGINT)
+		{
+			// Ctrl-C stops a loop even when only builtins run in it
+			shell->last_status = 128 + SIGINT;
+			break ;
+		}
+		pc = next;
+	}
+	pc = prog->slots;
+	while (pc-- > 0)
+		clear_slot(&slots[pc]);
+	free(slots);
+	vm_release(prog);
+	return (shell->last_status);
+}